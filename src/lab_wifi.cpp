@@ -5,6 +5,10 @@
 #include <unordered_map>
 #include <deque>
 #include "oui_lookup.h"
+#include "mgmt_frame.h"
+#include "net_inventory.h"
+#include "summary_stream.h"
+#include "metric_store.h"
 
 LabWiFiImp LabWiFi;
 
@@ -21,6 +25,53 @@ unsigned long start_time = 0;
 char packet_rate[20];
 bool display_lock = false;
 
+// Written from the WiFi task, read from the main loop
+static NetInventory inventory;
+static portMUX_TYPE inventory_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Flushed by summary_task on a fixed period; summary_lock keeps start/stop from racing a
+// flush that is still sending
+static SummaryStream summary;
+static SemaphoreHandle_t summary_lock = nullptr;
+
+#define SUMMARY_TASK_STACK 4096
+#define SUMMARY_TASK_PRIORITY 2 // above loopTask, so a blocked loop() cannot stretch a batch
+
+static const char *OUI_DB_FILE = "/sd_card/ouis.lpm";
+static const char *OUI_TRIE_FILE = "/sd_card/ouis.jmt";
+
+// Metric history. The callbacks only touch second_metrics. The rings are written by
+// metrics_task once a second and read by serial queries, both holding metrics_lock.
+// Capacities assume one busy channel, where a sample encodes to roughly 8-9 bytes
+#define METRIC_SECOND_BLOCKS 48 // ~24 KB, about 45 minutes of per-second samples
+#define METRIC_MINUTE_BLOCKS 48 // ~24 KB, about 40 hours of per-minute samples
+
+// A per-second block fills in about a minute, so this only matters on a quiet channel.
+// Per-minute blocks take most of an hour to fill and are normally closed only when
+// full; the long interval just bounds how much history a reboot can lose.
+#define METRIC_SECOND_CLOSE_INTERVAL 600        // seconds between forced closes
+#define METRIC_MINUTE_CLOSE_INTERVAL (6 * 3600) // seconds between forced closes
+
+static const char *METRIC_SECOND_FILE = "/sd_card/metrics_sec.bin";
+static const char *METRIC_MINUTE_FILE = "/sd_card/metrics_min.bin";
+
+static ts_block_t second_blocks[METRIC_SECOND_BLOCKS];
+static ts_block_t minute_blocks[METRIC_MINUTE_BLOCKS];
+static MetricRing second_ring(second_blocks, METRIC_SECOND_BLOCKS);
+static MetricRing minute_ring(minute_blocks, METRIC_MINUTE_BLOCKS);
+static MetricAccumulator second_metrics;
+static MetricAccumulator minute_metrics;
+static portMUX_TYPE metrics_mux = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t metrics_lock = nullptr;
+
+#define METRIC_TASK_STACK 6144
+#define METRIC_TASK_PRIORITY 2 // above loopTask, so a blocked loop() cannot delay rollups
+
+static uint32_t metric_time_base = 0;
+static uint32_t metric_last_second = 0;
+static uint32_t metric_second_close = 0;
+static uint32_t metric_minute_close = 0;
+
 
 void set_display_lock(bool lock) {
     display_lock = lock;
@@ -66,12 +117,75 @@ void clear_display() {
 
 
 
+// Beacons, probe responses and probe requests feed the network inventory. This runs at
+// full beacon rate, so it must not allocate or touch the display/SD card.
+static bool handle_mgmt_packet(const wifi_promiscuous_pkt_t *pkt, mgmt_frame_info_t *info) {
+    int len = pkt->rx_ctrl.sig_len - FCS_LEN;
+    if (len <= 0) {
+        return false;
+    }
+
+    if (!parse_mgmt_frame(pkt->payload, len, info)) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&inventory_mux);
+    inventory.record(*info, pkt->rx_ctrl.rssi, pkt->rx_ctrl.channel, millis());
+    portEXIT_CRITICAL(&inventory_mux);
+    return true;
+}
+
+static void record_metrics(const wifi_promiscuous_pkt_t *pkt) {
+    const uint8_t *mac = nullptr;
+    if (pkt->rx_ctrl.sig_len >= sizeof(wifi_ieee80211_packet_t)) {
+        mac = ((const wifi_ieee80211_packet_t *)pkt->payload)->addr2;
+    }
+    portENTER_CRITICAL(&metrics_mux);
+    second_metrics.add_frame(pkt->rx_ctrl.channel, pkt->rx_ctrl.sig_len, pkt->rx_ctrl.rssi, mac);
+    portEXIT_CRITICAL(&metrics_mux);
+}
+
+// Promiscuous callback used in station mode when the summary stream is enabled. Only
+// records sightings; the main loop sends them to the collector.
+void summary_rx_packet(void *buf, wifi_promiscuous_pkt_type_t type) {
+    wifi_promiscuous_pkt_t *pkt = (wifi_promiscuous_pkt_t *)buf;
+    uint8_t channel = pkt->rx_ctrl.channel;
+    int8_t frame_rssi = pkt->rx_ctrl.rssi;
+    record_metrics(pkt);
+
+    if (type == WIFI_PKT_MGMT) {
+        mgmt_frame_info_t info;
+        if (!handle_mgmt_packet(pkt, &info)) {
+            return;
+        }
+        if (info.subtype == MGMT_SUBTYPE_PROBE_REQ) {
+            summary.record(info.source, SUMMARY_KIND_CLIENT, channel, frame_rssi);
+        } else {
+            summary.record(info.bssid, SUMMARY_KIND_AP, info.channel ? info.channel : channel,
+                           frame_rssi);
+        }
+        return;
+    }
+
+    if (type != WIFI_PKT_DATA || pkt->rx_ctrl.sig_len < sizeof(wifi_ieee80211_packet_t)) {
+        return;
+    }
+    wifi_ieee80211_packet_t *wifi_pkt = (wifi_ieee80211_packet_t *)pkt->payload;
+    summary.record(wifi_pkt->addr2, SUMMARY_KIND_DATA, channel, frame_rssi);
+}
+
 void wifi_sniffer_rx_packet(void *buf, wifi_promiscuous_pkt_type_t type) {
-    // We only care about data packets
+    wifi_promiscuous_pkt_t *pkt = (wifi_promiscuous_pkt_t *)buf;
+    record_metrics(pkt);
+    if (type == WIFI_PKT_MGMT) {
+        mgmt_frame_info_t info;
+        handle_mgmt_packet(pkt, &info);
+        return;
+    }
+    // Only data packets drive the LEDs and display
     if (type != WIFI_PKT_DATA) {
         return;
     }
-    wifi_promiscuous_pkt_t *pkt = (wifi_promiscuous_pkt_t *)buf;
     wifi_pkt_rx_ctrl_t header = (wifi_pkt_rx_ctrl_t)pkt->rx_ctrl;
     rssi = map(header.rssi, -90, -40, 0, 255);
 
@@ -107,28 +221,29 @@ void wifi_sniffer_rx_packet(void *buf, wifi_promiscuous_pkt_type_t type) {
              wifi_pkt->addr3[1], wifi_pkt->addr3[2], wifi_pkt->addr3[3], wifi_pkt->addr3[4],
              wifi_pkt->addr3[5]);
 
-    char oui_1[7];
-    char oui_2[7];
-
-    // to extract OUI from MAC address
-    auto extractOUI = [](const char *mac, char *oui) {
-        int j = 0;
-        for (int i = 0; i < 9; ++i) { // 9 because "xx:xx:xx"
-            if (mac[i] != ':') {
-                oui[j++] = mac[i];
-            }
+    // Group and randomized addresses have no registered prefix, so they skip the lookup
+    // entirely. addr3 is the destination of to-DS data frames and is often broadcast.
+    auto lookup_manufacturer = [](const uint8_t *mac) -> String {
+        if (isGroupAddress(mac)) {
+            static const uint8_t broadcast[6] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+            return memcmp(mac, broadcast, 6) == 0 ? "Broadcast" : "Multicast";
+        }
+        if (isLocallyAdministered(mac)) {
+            return "Randomized MAC";
         }
-        oui[6] = '\0';
+        if (ouiDatabaseLoaded()) {
+            return findManufacturer(mac);
+        }
+        // The older trie format only knows 24-bit MA-L prefixes
+        char oui[7];
+        snprintf(oui, sizeof(oui), "%02X%02X%02X", mac[0], mac[1], mac[2]);
+        return findManufacturer(OUI_TRIE_FILE, oui);
     };
 
-    extractOUI(mac_addr_1, oui_1);
-    extractOUI(mac_addr_2, oui_2);
-
-
     String content_1, content_2;
-    if (SD.exists("/sd_card/ouis.jmt")) {
-        content_1 = findManufacturer("/sd_card/ouis.jmt", oui_1);
-        content_2 = findManufacturer("/sd_card/ouis.jmt", oui_2);
+    if (ouiDatabaseLoaded() || SD.exists(OUI_TRIE_FILE)) {
+        content_1 = lookup_manufacturer(wifi_pkt->addr2);
+        content_2 = lookup_manufacturer(wifi_pkt->addr3);
     }
     else {
         content_1 = "OUI Lookup";
@@ -202,6 +317,10 @@ void LabWiFiImp::start_sniffer() {
         }
     }
 
+    if (!ouiDatabaseLoaded() && SD.exists(OUI_DB_FILE)) {
+        loadOUIDatabase(OUI_DB_FILE);
+    }
+
     // Set up WiFi hardware
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
 
@@ -221,6 +340,9 @@ void LabWiFiImp::start_sniffer() {
     ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_NULL));
     ESP_ERROR_CHECK(esp_wifi_start());
+    wifi_promiscuous_filter_t filter = {
+        .filter_mask = WIFI_PROMIS_FILTER_MASK_MGMT | WIFI_PROMIS_FILTER_MASK_DATA};
+    ESP_ERROR_CHECK(esp_wifi_set_promiscuous_filter(&filter));
     ESP_ERROR_CHECK(esp_wifi_set_promiscuous(true));
     ESP_ERROR_CHECK(esp_wifi_set_promiscuous_rx_cb(wifi_sniffer_rx_packet));
 
@@ -250,11 +372,304 @@ void LabWiFiImp::start_client() {
 }
 
 void LabWiFiImp::stop_client() {
+    stop_summary_stream();
     WiFi.disconnect(true, true);
 }
 
+static void summary_task(void *arg) {
+    TickType_t wake = xTaskGetTickCount();
+    while (true) {
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(SUMMARY_FLUSH_INTERVAL_MS));
+        xSemaphoreTake(summary_lock, portMAX_DELAY);
+        summary.flush();
+        xSemaphoreGive(summary_lock);
+    }
+}
+
+void LabWiFiImp::start_summary_stream(const char *host, uint16_t port) {
+    if (summary.active()) {
+        return;
+    }
+
+    uint8_t board_id[6];
+    WiFi.macAddress(board_id);
+    if (summary_lock == nullptr) {
+        summary_lock = xSemaphoreCreateMutex();
+        xTaskCreatePinnedToCore(summary_task, "summary", SUMMARY_TASK_STACK, nullptr,
+                                SUMMARY_TASK_PRIORITY, nullptr, ARDUINO_RUNNING_CORE);
+    }
+    xSemaphoreTake(summary_lock, portMAX_DELAY);
+    summary.begin(host, port, board_id);
+    xSemaphoreGive(summary_lock);
+
+    // The radio stays on the access point's channel, so only that channel is summarized
+    wifi_promiscuous_filter_t filter = {
+        .filter_mask = WIFI_PROMIS_FILTER_MASK_MGMT | WIFI_PROMIS_FILTER_MASK_DATA};
+    ESP_ERROR_CHECK(esp_wifi_set_promiscuous_filter(&filter));
+    ESP_ERROR_CHECK(esp_wifi_set_promiscuous_rx_cb(summary_rx_packet));
+    ESP_ERROR_CHECK(esp_wifi_set_promiscuous(true));
+    Serial.printf("Sending summary stream to %s:%u\n", host, port);
+}
+
+void LabWiFiImp::stop_summary_stream() {
+    if (!summary.active()) {
+        return;
+    }
+    esp_wifi_set_promiscuous(false);
+    xSemaphoreTake(summary_lock, portMAX_DELAY);
+    summary.end();
+    xSemaphoreGive(summary_lock);
+}
+
 void LabWiFiImp::clear_mac_data() {
     unique_macs.clear();
     mac_queue.clear();
 }
 
+void LabWiFiImp::clear_inventory() {
+    portENTER_CRITICAL(&inventory_mux);
+    inventory.clear();
+    portEXIT_CRITICAL(&inventory_mux);
+}
+
+void LabWiFiImp::print_inventory() {
+    unsigned long now = millis();
+
+    // Copy one entry at a time so the sniffer callback is never blocked on Serial
+    Serial.println("BSSID              CH  RSSI  INT   SEC   BEACONS  AGE(s)  SSID");
+    for (size_t i = 0;; i++) {
+        network_entry_t entry;
+        portENTER_CRITICAL(&inventory_mux);
+        bool valid = i < inventory.network_count();
+        if (valid) {
+            entry = inventory.network(i);
+        }
+        portEXIT_CRITICAL(&inventory_mux);
+        if (!valid) {
+            break;
+        }
+        Serial.printf("%02X:%02X:%02X:%02X:%02X:%02X  %2u  %4d  %4u  %-4s  %7lu  %6lu  %s\n",
+                      entry.bssid[0], entry.bssid[1], entry.bssid[2], entry.bssid[3],
+                      entry.bssid[4], entry.bssid[5], entry.channel, entry.rssi,
+                      entry.beacon_interval, security_name(entry.security),
+                      (unsigned long)entry.beacons, (now - entry.last_seen) / 1000,
+                      entry.ssid[0] ? entry.ssid : "<hidden>");
+    }
+
+    Serial.println("CLIENT             RSSI  PROBES  AGE(s)  LAST SSID");
+    for (size_t i = 0;; i++) {
+        client_entry_t entry;
+        portENTER_CRITICAL(&inventory_mux);
+        bool valid = i < inventory.client_count();
+        if (valid) {
+            entry = inventory.client(i);
+        }
+        portEXIT_CRITICAL(&inventory_mux);
+        if (!valid) {
+            break;
+        }
+        Serial.printf("%02X:%02X:%02X:%02X:%02X:%02X  %4d  %6lu  %6lu  %s\n", entry.mac[0],
+                      entry.mac[1], entry.mac[2], entry.mac[3], entry.mac[4], entry.mac[5],
+                      entry.rssi, (unsigned long)entry.probes, (now - entry.last_seen) / 1000,
+                      entry.last_ssid[0] ? entry.last_ssid : "<any>");
+    }
+}
+
+static uint32_t metric_now() {
+    return metric_time_base + millis() / 1000;
+}
+
+// Returns the end time of the last block in a metric file, or 0 if there is none
+static uint32_t last_metric_time(const char *filename) {
+    File file = SD.open(filename, FILE_READ);
+    if (!file) {
+        return 0;
+    }
+    ts_block_header_t header = {};
+    size_t count = file.size() / sizeof(ts_block_t);
+    if (count > 0) {
+        file.seek((count - 1) * sizeof(ts_block_t));
+        file.read((uint8_t *)&header, sizeof(header));
+    }
+    file.close();
+    return header.end_time;
+}
+
+// Appends closed blocks to the SD card. Blocks are written whole, so the file is an array
+// of fixed-size records that can be searched by time without reading the data.
+static void flush_metric_blocks(MetricRing &ring, const char *filename) {
+    const ts_block_t *block = ring.pop_unflushed();
+    if (block == nullptr || SD.cardType() == CARD_NONE) {
+        return;
+    }
+    File file = SD.open(filename, FILE_APPEND);
+    if (!file) {
+        Serial.printf("Could not open %s\n", filename);
+        return;
+    }
+    while (block != nullptr) {
+        file.write((const uint8_t *)block, sizeof(ts_block_t));
+        block = ring.pop_unflushed();
+    }
+    file.close();
+}
+
+// Runs a query over the blocks already flushed to a metric file
+static size_t query_metric_file(const char *filename, const metric_query_t &query) {
+    File file = SD.open(filename, FILE_READ);
+    if (!file) {
+        return 0;
+    }
+    size_t count = file.size() / sizeof(ts_block_t);
+
+    // Blocks are appended in time order, so binary search for the first one in range
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        ts_block_header_t header;
+        file.seek(mid * sizeof(ts_block_t));
+        file.read((uint8_t *)&header, sizeof(header));
+        if (header.end_time < query.from) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    static ts_block_t block;
+    size_t emitted = 0;
+    for (size_t i = low; i < count; i++) {
+        file.seek(i * sizeof(ts_block_t));
+        if (file.read((uint8_t *)&block, sizeof(block)) != sizeof(block) ||
+            block.header.start_time > query.to) {
+            break;
+        }
+        emitted += query_block(block.header, block.data, query);
+    }
+    file.close();
+    return emitted;
+}
+
+static void print_metric_value(uint32_t time, int32_t value, void *ctx) {
+    Serial.printf("%lu,%ld\n", (unsigned long)time, (long)value);
+}
+
+// Turns the last second of frames into a sample. Each call covers exactly one second on
+// the metrics clock, whatever the main loop happens to be doing.
+static void roll_up_second() {
+    MetricAccumulator snapshot;
+    portENTER_CRITICAL(&metrics_mux);
+    snapshot = second_metrics;
+    second_metrics.clear();
+    portEXIT_CRITICAL(&metrics_mux);
+
+    uint32_t second = metric_last_second;
+    metric_sample_t sample;
+    snapshot.to_sample(second, &sample);
+
+    xSemaphoreTake(metrics_lock, portMAX_DELAY);
+    second_ring.append(sample);
+    minute_metrics.merge(snapshot);
+
+    if ((second + 1) % 60 == 0) {
+        minute_metrics.to_sample(second / 60 * 60, &sample);
+        minute_ring.append(sample);
+        minute_metrics.clear();
+    }
+    metric_last_second = second + 1;
+
+    if (second - metric_second_close >= METRIC_SECOND_CLOSE_INTERVAL) {
+        second_ring.close_block();
+        metric_second_close = second;
+    }
+    if (second - metric_minute_close >= METRIC_MINUTE_CLOSE_INTERVAL) {
+        minute_ring.close_block();
+        metric_minute_close = second;
+    }
+    flush_metric_blocks(second_ring, METRIC_SECOND_FILE);
+    flush_metric_blocks(minute_ring, METRIC_MINUTE_FILE);
+    xSemaphoreGive(metrics_lock);
+}
+
+static void metrics_task(void *arg) {
+    TickType_t wake = xTaskGetTickCount();
+    while (true) {
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(1000));
+        roll_up_second();
+    }
+}
+
+void LabWiFiImp::start_metrics() {
+    if (metrics_lock != nullptr) {
+        return;
+    }
+
+    // Continue the clock from the previous session so SD history stays in time order
+    if (SD.cardType() != CARD_NONE) {
+        uint32_t last =
+            max(last_metric_time(METRIC_SECOND_FILE), last_metric_time(METRIC_MINUTE_FILE));
+        if (last > 0) {
+            metric_time_base = last + 60;
+        }
+    }
+    metric_last_second = metric_now();
+    metric_second_close = metric_last_second;
+    metric_minute_close = metric_last_second;
+
+    metrics_lock = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(metrics_task, "metrics", METRIC_TASK_STACK, nullptr,
+                            METRIC_TASK_PRIORITY, nullptr, ARDUINO_RUNNING_CORE);
+}
+
+uint32_t LabWiFiImp::metrics_time() {
+    return metric_last_second;
+}
+
+void LabWiFiImp::query_metrics(metric_t metric, uint8_t channel, uint32_t from, uint32_t to,
+                               bool per_minute) {
+    MetricRing &ring = per_minute ? minute_ring : second_ring;
+    const char *filename = per_minute ? METRIC_MINUTE_FILE : METRIC_SECOND_FILE;
+    metric_query_t query = {metric, channel, from, to, print_metric_value, nullptr};
+
+    Serial.println("time,value");
+    size_t emitted = 0;
+
+    xSemaphoreTake(metrics_lock, portMAX_DELAY);
+    uint32_t ram_start = ring.empty() ? UINT32_MAX : ring.oldest_time();
+    uint32_t sequence = ring.first_sequence();
+    xSemaphoreGive(metrics_lock);
+
+    // Older history only lives on the SD card. Stop short of what is still in RAM so
+    // blocks that were flushed are not reported twice.
+    if (from < ram_start && SD.cardType() != CARD_NONE) {
+        metric_query_t file_query = query;
+        file_query.to = min(to, ram_start - 1);
+        emitted += query_metric_file(filename, file_query);
+    }
+
+    // Copy one block at a time so printing never holds up metrics_task
+    static ts_block_t block;
+    while (true) {
+        xSemaphoreTake(metrics_lock, portMAX_DELAY);
+        sequence = max(sequence, ring.first_sequence());
+        bool copied = ring.copy_block(sequence, &block);
+        xSemaphoreGive(metrics_lock);
+        if (!copied) {
+            break;
+        }
+        emitted += query_block(block.header, block.data, query);
+        sequence++;
+    }
+    Serial.printf("%u samples\n", (unsigned)emitted);
+}
+
+void LabWiFiImp::print_metrics_status() {
+    xSemaphoreTake(metrics_lock, portMAX_DELAY);
+    Serial.printf("Metrics clock: %lu s\n", (unsigned long)metric_last_second);
+    Serial.printf("Per-second history: %u bytes in RAM, since %lu\n",
+                  (unsigned)second_ring.bytes_used(), (unsigned long)second_ring.oldest_time());
+    Serial.printf("Per-minute history: %u bytes in RAM, since %lu\n",
+                  (unsigned)minute_ring.bytes_used(), (unsigned long)minute_ring.oldest_time());
+    xSemaphoreGive(metrics_lock);
+}
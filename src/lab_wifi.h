@@ -8,6 +8,7 @@
 
 #include "esp_wifi.h"
 #include "esp_wifi_types.h"
+#include "metric_store.h"
 
 typedef struct {
     int16_t frame_ctrl;
@@ -52,7 +53,16 @@ class LabWiFiImp {
     void stop_sniffer();
     void start_client();
     void stop_client();
+    void start_summary_stream(const char *host, uint16_t port);
+    void stop_summary_stream();
+    void start_metrics();
+    uint32_t metrics_time();
+    void query_metrics(metric_t metric, uint8_t channel, uint32_t from, uint32_t to,
+                       bool per_minute);
+    void print_metrics_status();
     void clear_mac_data();
+    void clear_inventory();
+    void print_inventory();
    
 
   private:
@@ -9,6 +9,10 @@ static const String ssid = "BYU-WiFi";
 static const String password = "";
 static const String server_url = "http://ecen192.byu.edu:5000";
 
+// Host running tools/collector. Leave empty to disable the summary stream.
+static const String summary_host = "";
+static const uint16_t summary_port = 5005;
+
 static bool station_mode = false;
 static bool monitor_mode = false;
 
@@ -19,6 +23,8 @@ typedef struct {
 
 bool get_credentials(credentials_t *credentials);
 bool poll_server();
+void handle_serial_command();
+void handle_query_command(const String &command);
 
 int sniffed_packet = 0;
 int sniffed_packet_old = 0;
@@ -61,11 +67,12 @@ void setup() {
     Serial.begin(9600);
     Yboard.setup();
     LabWiFi.setup(ssid, password, &sniffed_packet, leds);
+    LabWiFi.start_metrics();
     time_since_packet = millis();
 }
 
 void loop() {
-    
+    handle_serial_command();
 
     if (Yboard.get_switch(2)) {
         if (!station_mode) {
@@ -77,6 +84,10 @@ void loop() {
 
             LabWiFi.start_client();
             station_mode = true;
+
+            if (summary_host.length() > 0) {
+                LabWiFi.start_summary_stream(summary_host.c_str(), summary_port);
+            }
         }
 
         if (credentials.id == NULL || credentials.password == NULL) {
@@ -138,6 +149,64 @@ void loop() {
     }
 }
 
+// Reads a newline-terminated command from the serial port, if one is pending
+void handle_serial_command() {
+    if (!Serial.available()) {
+        return;
+    }
+
+    String command = Serial.readStringUntil('\n');
+    command.trim();
+
+    if (command == "inventory") {
+        LabWiFi.print_inventory();
+    }
+    else if (command == "clear inventory") {
+        LabWiFi.clear_inventory();
+    }
+    else if (command == "metrics") {
+        LabWiFi.print_metrics_status();
+    }
+    else if (command.startsWith("query ")) {
+        handle_query_command(command);
+    }
+    else if (command.length() > 0) {
+        Serial.printf("Unknown command: %s\n", command.c_str());
+    }
+}
+
+// query <frames|bytes|devices|rssi> <channel|all> <from> <to> [min]
+// Times are seconds on the metrics clock; values <= 0 are relative to now.
+void handle_query_command(const String &command) {
+    char metric_name[16];
+    char channel_name[8];
+    char resolution[8] = "sec";
+    long from, to;
+
+    int fields = sscanf(command.c_str(), "query %15s %7s %ld %ld %7s", metric_name, channel_name,
+                        &from, &to, resolution);
+    metric_t metric;
+    if (fields < 4 || !parse_metric_name(metric_name, &metric)) {
+        Serial.println("Usage: query <frames|bytes|devices|rssi> <channel|all> <from> <to> [min]");
+        return;
+    }
+
+    int channel = strcmp(channel_name, "all") == 0 ? 0 : atoi(channel_name);
+    if (channel < 0 || channel > TS_CHANNELS) {
+        Serial.printf("Invalid channel: %s\n", channel_name);
+        return;
+    }
+
+    long now = LabWiFi.metrics_time();
+    if (from <= 0) {
+        from = max(now + from, 0L);
+    }
+    if (to <= 0) {
+        to = max(now + to, 0L);
+    }
+    LabWiFi.query_metrics(metric, channel, from, to, strcmp(resolution, "min") == 0);
+}
+
 bool poll_server() {
     HTTPClient http;
     http.begin(server_url + "/poll_commands");
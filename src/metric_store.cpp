@@ -0,0 +1,314 @@
+#include "metric_store.h"
+#include <math.h>
+#include <string.h>
+
+static const char *METRIC_NAMES[METRIC_COUNT] = {"frames", "bytes", "devices", "rssi"};
+
+static inline uint32_t zigzag(uint32_t delta) {
+    int32_t value = (int32_t)delta;
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline uint32_t unzigzag(uint32_t value) {
+    return (value >> 1) ^ (uint32_t)-(int32_t)(value & 1);
+}
+
+static inline uint8_t *put_varint(uint8_t *p, uint32_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+static inline bool get_varint(const uint8_t *&p, const uint8_t *end, uint32_t *value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        result |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Channels without frames are left out of the encoding and come back as all zeros
+static size_t encode_sample(const metric_sample_t &sample, const metric_sample_t &prev,
+                            uint8_t *out) {
+    uint16_t mask = 0;
+    for (int ch = 0; ch < TS_CHANNELS; ch++) {
+        if (sample.channels[ch].frames) {
+            mask |= 1 << ch;
+        }
+    }
+
+    uint8_t *p = put_varint(out, sample.time - prev.time);
+    p = put_varint(p, mask);
+    for (int ch = 0; ch < TS_CHANNELS; ch++) {
+        if (!(mask & (1 << ch))) {
+            continue;
+        }
+        const channel_metrics_t &cur = sample.channels[ch];
+        const channel_metrics_t &old = prev.channels[ch];
+        p = put_varint(p, zigzag(cur.frames - old.frames));
+        p = put_varint(p, zigzag(cur.bytes - old.bytes));
+        p = put_varint(p, zigzag(cur.devices - old.devices));
+        p = put_varint(p, zigzag((uint32_t)cur.rssi - (uint32_t)old.rssi));
+    }
+    return p - out;
+}
+
+// Applies one encoded sample on top of state
+static bool decode_sample(const uint8_t *&p, const uint8_t *end, metric_sample_t *state) {
+    uint32_t time_delta, mask;
+    if (!get_varint(p, end, &time_delta) || !get_varint(p, end, &mask)) {
+        return false;
+    }
+    state->time += time_delta;
+    for (int ch = 0; ch < TS_CHANNELS; ch++) {
+        channel_metrics_t &cur = state->channels[ch];
+        if (!(mask & (1 << ch))) {
+            memset(&cur, 0, sizeof(cur));
+            continue;
+        }
+        uint32_t deltas[4];
+        for (int i = 0; i < 4; i++) {
+            if (!get_varint(p, end, &deltas[i])) {
+                return false;
+            }
+        }
+        cur.frames += unzigzag(deltas[0]);
+        cur.bytes += unzigzag(deltas[1]);
+        cur.devices += unzigzag(deltas[2]);
+        cur.rssi = (int32_t)((uint32_t)cur.rssi + unzigzag(deltas[3]));
+    }
+    return true;
+}
+
+// Returns false if the sample has nothing meaningful to report for the metric
+static bool sample_value(const metric_sample_t &sample, metric_t metric, uint8_t channel,
+                         int32_t *value) {
+    int first = channel ? channel - 1 : 0;
+    int last = channel ? channel - 1 : TS_CHANNELS - 1;
+    int64_t total = 0;
+    int64_t frames = 0;
+
+    for (int ch = first; ch <= last; ch++) {
+        const channel_metrics_t &cur = sample.channels[ch];
+        switch (metric) {
+        case METRIC_FRAMES:
+            total += cur.frames;
+            break;
+        case METRIC_BYTES:
+            total += cur.bytes;
+            break;
+        case METRIC_DEVICES:
+            total += cur.devices;
+            break;
+        case METRIC_RSSI:
+            // Combine channels weighted by how many frames each contributed
+            total += (int64_t)cur.rssi * cur.frames;
+            frames += cur.frames;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    if (metric == METRIC_RSSI) {
+        if (frames == 0) {
+            return false;
+        }
+        total /= frames;
+    }
+    *value = (int32_t)total;
+    return true;
+}
+
+size_t query_block(const ts_block_header_t &header, const uint8_t *data,
+                   const metric_query_t &query) {
+    if (header.count == 0 || header.end_time < query.from || header.start_time > query.to) {
+        return 0;
+    }
+
+    metric_sample_t state;
+    memset(&state, 0, sizeof(state));
+    const uint8_t *p = data;
+    const uint8_t *end = data + header.used;
+    size_t emitted = 0;
+
+    for (uint16_t i = 0; i < header.count; i++) {
+        if (!decode_sample(p, end, &state)) {
+            break;
+        }
+        if (state.time > query.to) {
+            break;
+        }
+        int32_t value;
+        if (state.time >= query.from &&
+            sample_value(state, query.metric, query.channel, &value)) {
+            query.emit(state.time, value, query.ctx);
+            emitted++;
+        }
+    }
+    return emitted;
+}
+
+bool parse_metric_name(const char *name, metric_t *metric) {
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        if (strcmp(name, METRIC_NAMES[i]) == 0) {
+            *metric = (metric_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MetricAccumulator::add_frame(uint8_t channel, uint16_t len, int8_t rssi,
+                                  const uint8_t *mac) {
+    if (channel < 1 || channel > TS_CHANNELS) {
+        return;
+    }
+    auto &cur = channels[channel - 1];
+    cur.frames++;
+    cur.bytes += len;
+    cur.rssi_sum += rssi;
+
+    if (mac != nullptr) {
+        // FNV-1a over the address picks one bit of the sketch
+        uint32_t hash = 2166136261u;
+        for (int i = 0; i < 6; i++) {
+            hash = (hash ^ mac[i]) * 16777619u;
+        }
+        uint32_t bit = hash % TS_DEVICE_SKETCH_BITS;
+        cur.device_bits[bit / 32] |= 1u << (bit % 32);
+    }
+}
+
+void MetricAccumulator::merge(const MetricAccumulator &other) {
+    for (int ch = 0; ch < TS_CHANNELS; ch++) {
+        auto &cur = channels[ch];
+        const auto &add = other.channels[ch];
+        cur.frames += add.frames;
+        cur.bytes += add.bytes;
+        cur.rssi_sum += add.rssi_sum;
+        for (int i = 0; i < TS_DEVICE_SKETCH_BITS / 32; i++) {
+            cur.device_bits[i] |= add.device_bits[i];
+        }
+    }
+}
+
+void MetricAccumulator::to_sample(uint32_t time, metric_sample_t *sample) const {
+    sample->time = time;
+    for (int ch = 0; ch < TS_CHANNELS; ch++) {
+        const auto &cur = channels[ch];
+        channel_metrics_t &out = sample->channels[ch];
+        if (cur.frames == 0) {
+            memset(&out, 0, sizeof(out));
+            continue;
+        }
+        out.frames = cur.frames;
+        out.bytes = cur.bytes;
+        out.rssi = (int32_t)lroundf((float)cur.rssi_sum / cur.frames);
+
+        // Linear counting: n = -m * ln(zero bits / m)
+        int set_bits = 0;
+        for (int i = 0; i < TS_DEVICE_SKETCH_BITS / 32; i++) {
+            set_bits += __builtin_popcount(cur.device_bits[i]);
+        }
+        int zero_bits = TS_DEVICE_SKETCH_BITS - set_bits;
+        if (zero_bits == 0) {
+            zero_bits = 1; // saturated, report the sketch's upper bound
+        }
+        out.devices = (uint32_t)lroundf(-(float)TS_DEVICE_SKETCH_BITS *
+                                         logf((float)zero_bits / TS_DEVICE_SKETCH_BITS));
+    }
+}
+
+void MetricAccumulator::clear() {
+    memset(channels, 0, sizeof(channels));
+}
+
+MetricRing::MetricRing(ts_block_t *blocks, size_t block_count)
+    : blocks(blocks), block_count(block_count), head(0), valid(1), started(1), next_flush(0) {
+    memset(&blocks[0].header, 0, sizeof(ts_block_header_t));
+    memset(&prev, 0, sizeof(prev));
+}
+
+void MetricRing::start_block() {
+    head = (head + 1) % block_count;
+    if (valid < block_count) {
+        valid++;
+    }
+    started++;
+    // Blocks that were overwritten before anyone flushed them are gone
+    if (next_flush < started - valid) {
+        next_flush = started - valid;
+    }
+    memset(&current().header, 0, sizeof(ts_block_header_t));
+    memset(&prev, 0, sizeof(prev));
+}
+
+void MetricRing::append(const metric_sample_t &sample) {
+    uint8_t encoded[TS_MAX_SAMPLE_LEN];
+    size_t len = encode_sample(sample, prev, encoded);
+    if (current().header.used + len > TS_BLOCK_DATA) {
+        start_block();
+        len = encode_sample(sample, prev, encoded);
+    }
+
+    ts_block_t &block = current();
+    memcpy(block.data + block.header.used, encoded, len);
+    block.header.used += len;
+    if (block.header.count == 0) {
+        block.header.start_time = sample.time;
+    }
+    block.header.end_time = sample.time;
+    block.header.count++;
+    prev = sample;
+}
+
+void MetricRing::close_block() {
+    if (current().header.count > 0) {
+        start_block();
+    }
+}
+
+const ts_block_t *MetricRing::pop_unflushed() {
+    // The current block (sequence started - 1) is still being written
+    if (next_flush + 1 >= started) {
+        return nullptr;
+    }
+    size_t age = started - 1 - next_flush;
+    next_flush++;
+    return &blocks[(head + block_count - age) % block_count];
+}
+
+bool MetricRing::copy_block(uint32_t sequence, ts_block_t *out) const {
+    if (sequence < started - valid || sequence >= started) {
+        return false;
+    }
+    *out = blocks[(head + block_count - (started - 1 - sequence)) % block_count];
+    return true;
+}
+
+uint32_t MetricRing::oldest_time() const {
+    for (size_t i = valid; i > 0; i--) {
+        const ts_block_t &block = blocks[(head + block_count - (i - 1)) % block_count];
+        if (block.header.count > 0) {
+            return block.header.start_time;
+        }
+    }
+    return 0;
+}
+
+size_t MetricRing::bytes_used() const {
+    size_t total = 0;
+    for (size_t i = valid; i > 0; i--) {
+        total += blocks[(head + block_count - (i - 1)) % block_count].header.used;
+    }
+    return total;
+}
@@ -0,0 +1,127 @@
+#ifndef METRIC_STORE_H
+#define METRIC_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Time-series storage for sniffer metrics.
+//
+// Samples are delta encoded against the previous sample and written as zigzag varints
+// into fixed-size blocks. Every block starts from an all-zero state and carries a header
+// with its time range, so a range query only decodes the blocks that overlap the window
+// and a block can be written to SD as-is. The RAM ring overwrites its oldest block when
+// full.
+
+#define TS_CHANNELS 14
+#define TS_BLOCK_DATA 500
+#define TS_DEVICE_SKETCH_BITS 256 // linear-counting sketch per channel, must be a multiple of 32
+
+// Largest possible encoding of one sample: time + channel mask + four values per channel
+#define TS_MAX_SAMPLE_LEN (5 + 3 + TS_CHANNELS * 4 * 5)
+
+typedef enum {
+    METRIC_FRAMES = 0,
+    METRIC_BYTES,
+    METRIC_DEVICES,
+    METRIC_RSSI,
+    METRIC_COUNT,
+} metric_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t devices; // estimated distinct transmitters
+    int32_t rssi;     // mean RSSI in dBm, 0 if no frames
+} channel_metrics_t;
+
+typedef struct {
+    uint32_t time; // seconds on the store clock
+    channel_metrics_t channels[TS_CHANNELS];
+} metric_sample_t;
+
+typedef struct {
+    uint32_t start_time;
+    uint32_t end_time;
+    uint16_t count; // samples in the block
+    uint16_t used;  // bytes of data in use
+} ts_block_header_t;
+
+typedef struct {
+    ts_block_header_t header;
+    uint8_t data[TS_BLOCK_DATA];
+} ts_block_t;
+
+typedef void (*metric_emit_t)(uint32_t time, int32_t value, void *ctx);
+
+typedef struct {
+    metric_t metric;
+    uint8_t channel; // 1-14, or 0 to combine all channels
+    uint32_t from;   // inclusive
+    uint32_t to;     // inclusive
+    metric_emit_t emit;
+    void *ctx;
+} metric_query_t;
+
+// Collects raw frame observations between samples. Distinct devices are counted with a
+// small bitmap per channel, so per-second sketches can be merged into per-minute ones.
+class MetricAccumulator {
+  public:
+    MetricAccumulator() { clear(); }
+
+    void add_frame(uint8_t channel, uint16_t len, int8_t rssi, const uint8_t *mac);
+    void merge(const MetricAccumulator &other);
+    void to_sample(uint32_t time, metric_sample_t *sample) const;
+    void clear();
+
+  private:
+    struct {
+        uint32_t frames;
+        uint32_t bytes;
+        int32_t rssi_sum;
+        uint32_t device_bits[TS_DEVICE_SKETCH_BITS / 32];
+    } channels[TS_CHANNELS];
+};
+
+// Ring of encoded blocks over caller-provided storage
+class MetricRing {
+  public:
+    MetricRing(ts_block_t *blocks, size_t block_count);
+
+    void append(const metric_sample_t &sample);
+
+    // Closes the current block early so it becomes available to pop_unflushed()
+    void close_block();
+
+    // Returns closed blocks that have not been handed out yet, oldest first
+    const ts_block_t *pop_unflushed();
+
+    // Blocks are numbered in the order they were started. Lets a reader copy them one at a
+    // time and decode without holding up the writer.
+    uint32_t first_sequence() const { return started - valid; }
+    bool copy_block(uint32_t sequence, ts_block_t *out) const;
+
+    bool empty() const { return valid == 0 || (valid == 1 && current().header.count == 0); }
+    uint32_t oldest_time() const;
+    size_t bytes_used() const;
+
+  private:
+    ts_block_t &current() { return blocks[head]; }
+    const ts_block_t &current() const { return blocks[head]; }
+    void start_block();
+
+    ts_block_t *blocks;
+    size_t block_count;
+    size_t head;             // index of the block being written
+    size_t valid;            // blocks holding data, including the current one
+    uint32_t started;        // total blocks ever started
+    uint32_t next_flush;     // sequence number of the next block to hand out
+    metric_sample_t prev;
+};
+
+// Decodes one block and emits the samples that fall inside the query window
+size_t query_block(const ts_block_header_t &header, const uint8_t *data,
+                   const metric_query_t &query);
+
+bool parse_metric_name(const char *name, metric_t *metric);
+
+#endif /* METRIC_STORE_H */
@@ -0,0 +1,131 @@
+#include "mgmt_frame.h"
+
+static const uint8_t RSN_OUI[3] = {0x00, 0x0f, 0xac};
+static const uint8_t WPA_OUI[3] = {0x00, 0x50, 0xf2};
+
+static inline uint16_t read_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline bool oui_equals(const uint8_t *p, const uint8_t *oui) {
+    return p[0] == oui[0] && p[1] == oui[1] && p[2] == oui[2];
+}
+
+// Walks the AKM suite list of an RSN element to tell WPA3 (SAE) apart from WPA2
+static security_t parse_rsn(const ie_t &ie) {
+    // version (2) + group cipher (4) + pairwise count (2)
+    if (ie.len < 8) {
+        return SECURITY_WPA2;
+    }
+    size_t pos = 6;
+    uint16_t pairwise_count = read_le16(ie.data + pos);
+    pos += 2 + (size_t)pairwise_count * 4;
+    if (pos + 2 > ie.len) {
+        return SECURITY_WPA2;
+    }
+    uint16_t akm_count = read_le16(ie.data + pos);
+    pos += 2;
+    for (uint16_t i = 0; i < akm_count && pos + 4 <= ie.len; i++, pos += 4) {
+        const uint8_t *suite = ie.data + pos;
+        // AKM 8 is SAE, 24 is SAE with group-dependent hash
+        if (oui_equals(suite, RSN_OUI) && (suite[3] == 8 || suite[3] == 24)) {
+            return SECURITY_WPA3;
+        }
+    }
+    return SECURITY_WPA2;
+}
+
+bool parse_mgmt_frame(const uint8_t *frame, size_t len, mgmt_frame_info_t *info) {
+    if (len < MGMT_HEADER_LEN) {
+        return false;
+    }
+
+    // Frame control byte 0: version (2 bits), type (2 bits), subtype (4 bits)
+    uint8_t type = (frame[0] >> 2) & 0x3;
+    uint8_t subtype = (frame[0] >> 4) & 0xf;
+    if (type != 0) {
+        return false;
+    }
+
+    size_t body_offset = MGMT_HEADER_LEN;
+    if (subtype == MGMT_SUBTYPE_BEACON || subtype == MGMT_SUBTYPE_PROBE_RESP) {
+        body_offset += MGMT_FIXED_LEN;
+    } else if (subtype != MGMT_SUBTYPE_PROBE_REQ) {
+        return false;
+    }
+    if (len < body_offset) {
+        return false;
+    }
+
+    info->subtype = subtype;
+    info->source = frame + 10;
+    info->bssid = frame + 16;
+    info->ssid = nullptr;
+    info->ssid_len = 0;
+    info->channel = 0;
+    info->beacon_interval = 0;
+    info->capability = 0;
+    info->security = SECURITY_UNKNOWN;
+
+    if (subtype != MGMT_SUBTYPE_PROBE_REQ) {
+        const uint8_t *fixed = frame + MGMT_HEADER_LEN;
+        info->beacon_interval = read_le16(fixed + 8);
+        info->capability = read_le16(fixed + 10);
+        info->security = (info->capability & CAP_PRIVACY) ? SECURITY_WEP : SECURITY_OPEN;
+    }
+
+    IEIterator it(frame + body_offset, len - body_offset);
+    ie_t ie;
+    while (it.next(&ie)) {
+        switch (ie.id) {
+        case IE_SSID:
+            if (info->ssid == nullptr) {
+                info->ssid = ie.data;
+                info->ssid_len = ie.len > MAX_SSID_LEN ? MAX_SSID_LEN : ie.len;
+            }
+            break;
+        case IE_DS_PARAMS:
+            if (ie.len >= 1) {
+                info->channel = ie.data[0];
+            }
+            break;
+        case IE_RSN:
+            if (info->subtype != MGMT_SUBTYPE_PROBE_REQ) {
+                security_t rsn = parse_rsn(ie);
+                if (rsn > info->security) {
+                    info->security = rsn;
+                }
+            }
+            break;
+        case IE_VENDOR:
+            // Legacy WPA is advertised as a Microsoft vendor element of type 1
+            if (info->subtype != MGMT_SUBTYPE_PROBE_REQ && ie.len >= 4 &&
+                oui_equals(ie.data, WPA_OUI) && ie.data[3] == 1 &&
+                info->security < SECURITY_WPA) {
+                info->security = SECURITY_WPA;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+const char *security_name(security_t security) {
+    switch (security) {
+    case SECURITY_OPEN:
+        return "Open";
+    case SECURITY_WEP:
+        return "WEP";
+    case SECURITY_WPA:
+        return "WPA";
+    case SECURITY_WPA2:
+        return "WPA2";
+    case SECURITY_WPA3:
+        return "WPA3";
+    default:
+        return "?";
+    }
+}
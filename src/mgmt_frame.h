@@ -0,0 +1,89 @@
+#ifndef MGMT_FRAME_H
+#define MGMT_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 802.11 management frame layout
+#define MGMT_HEADER_LEN 24   // frame control through sequence control
+#define MGMT_FIXED_LEN 12    // timestamp (8) + beacon interval (2) + capability (2)
+#define FCS_LEN 4
+
+// Management frame subtypes
+#define MGMT_SUBTYPE_PROBE_REQ 0x4
+#define MGMT_SUBTYPE_PROBE_RESP 0x5
+#define MGMT_SUBTYPE_BEACON 0x8
+
+// Information element IDs
+#define IE_SSID 0
+#define IE_DS_PARAMS 3
+#define IE_RSN 48
+#define IE_VENDOR 221
+
+#define CAP_PRIVACY 0x0010
+#define MAX_SSID_LEN 32
+
+typedef enum {
+    SECURITY_UNKNOWN = 0,
+    SECURITY_OPEN,
+    SECURITY_WEP,
+    SECURITY_WPA,
+    SECURITY_WPA2,
+    SECURITY_WPA3,
+} security_t;
+
+// A single information element. data points into the frame buffer.
+typedef struct {
+    uint8_t id;
+    uint8_t len;
+    const uint8_t *data;
+} ie_t;
+
+// Iterates over the tagged parameters of a management frame body without copying.
+// Iteration stops at the first element whose length runs past the end of the buffer.
+class IEIterator {
+  public:
+    IEIterator(const uint8_t *data, size_t len) : pos(data), end(data + len) {}
+
+    bool next(ie_t *ie) {
+        if (end - pos < 2) {
+            return false;
+        }
+        uint8_t len = pos[1];
+        if ((size_t)(end - pos - 2) < len) {
+            pos = end;
+            return false;
+        }
+        ie->id = pos[0];
+        ie->len = len;
+        ie->data = pos + 2;
+        pos += 2 + len;
+        return true;
+    }
+
+  private:
+    const uint8_t *pos;
+    const uint8_t *end;
+};
+
+// Fields pulled out of a beacon, probe response or probe request. All pointers
+// reference the original frame buffer and are only valid for the duration of the callback.
+typedef struct {
+    uint8_t subtype;
+    const uint8_t *source; // addr2
+    const uint8_t *bssid;  // addr3
+    const uint8_t *ssid;
+    uint8_t ssid_len;
+    uint8_t channel; // 0 if the frame carried no DS parameter set
+    uint16_t beacon_interval;
+    uint16_t capability;
+    security_t security;
+} mgmt_frame_info_t;
+
+// Parses an 802.11 management frame (starting at frame control, FCS excluded).
+// Returns false for non-management frames, unsupported subtypes or truncated frames.
+bool parse_mgmt_frame(const uint8_t *frame, size_t len, mgmt_frame_info_t *info);
+
+const char *security_name(security_t security);
+
+#endif /* MGMT_FRAME_H */
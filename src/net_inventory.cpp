@@ -0,0 +1,88 @@
+#include "net_inventory.h"
+#include <string.h>
+
+// Copies an SSID element into a fixed buffer. Hidden networks broadcast either an
+// empty SSID or one filled with zeros, both of which are stored as an empty string.
+static void copy_ssid(char *dest, const uint8_t *ssid, uint8_t len) {
+    if (ssid == nullptr || len == 0 || ssid[0] == '\0') {
+        dest[0] = '\0';
+        return;
+    }
+    memcpy(dest, ssid, len);
+    dest[len] = '\0';
+}
+
+// Returns the slot holding mac, or the slot to overwrite if it is not present
+template <typename Entry, size_t N>
+static Entry *find_slot(Entry (&table)[N], size_t &count, const uint8_t *mac,
+                        uint8_t (Entry::*key)[6], bool *is_new) {
+    size_t oldest = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (memcmp(table[i].*key, mac, 6) == 0) {
+            *is_new = false;
+            return &table[i];
+        }
+        if (table[i].last_seen < table[oldest].last_seen) {
+            oldest = i;
+        }
+    }
+    *is_new = true;
+    if (count < N) {
+        return &table[count++];
+    }
+    return &table[oldest];
+}
+
+void NetInventory::record(const mgmt_frame_info_t &info, int8_t rssi, uint8_t rx_channel,
+                          uint32_t now) {
+    if (info.subtype == MGMT_SUBTYPE_PROBE_REQ) {
+        record_client(info, rssi, now);
+    } else {
+        // Prefer the channel the AP advertises; a beacon may be heard on an adjacent channel
+        record_network(info, rssi, info.channel ? info.channel : rx_channel, now);
+    }
+}
+
+void NetInventory::record_network(const mgmt_frame_info_t &info, int8_t rssi, uint8_t channel,
+                                  uint32_t now) {
+    bool is_new;
+    network_entry_t *entry =
+        find_slot(networks, num_networks, info.bssid, &network_entry_t::bssid, &is_new);
+    if (is_new) {
+        memcpy(entry->bssid, info.bssid, 6);
+        entry->beacons = 0;
+    }
+    // Probe responses to directed probes reveal the SSID of hidden networks, so only
+    // overwrite the name when this frame actually carries one
+    if (is_new || (info.ssid_len > 0 && info.ssid[0] != '\0')) {
+        copy_ssid(entry->ssid, info.ssid, info.ssid_len);
+    }
+    entry->channel = channel;
+    entry->rssi = rssi;
+    entry->beacon_interval = info.beacon_interval;
+    entry->security = info.security;
+    entry->beacons++;
+    entry->last_seen = now;
+}
+
+void NetInventory::record_client(const mgmt_frame_info_t &info, int8_t rssi, uint32_t now) {
+    bool is_new;
+    client_entry_t *entry =
+        find_slot(clients, num_clients, info.source, &client_entry_t::mac, &is_new);
+    if (is_new) {
+        memcpy(entry->mac, info.source, 6);
+        entry->last_ssid[0] = '\0';
+        entry->probes = 0;
+    }
+    if (info.ssid_len > 0) {
+        copy_ssid(entry->last_ssid, info.ssid, info.ssid_len);
+    }
+    entry->rssi = rssi;
+    entry->probes++;
+    entry->last_seen = now;
+}
+
+void NetInventory::clear() {
+    num_networks = 0;
+    num_clients = 0;
+}
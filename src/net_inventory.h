@@ -0,0 +1,57 @@
+#ifndef NET_INVENTORY_H
+#define NET_INVENTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mgmt_frame.h"
+
+// Fixed table sizes so recording from the sniffer callback never allocates
+#define INVENTORY_MAX_NETWORKS 48
+#define INVENTORY_MAX_CLIENTS 48
+
+typedef struct {
+    uint8_t bssid[6];
+    char ssid[MAX_SSID_LEN + 1]; // empty for hidden networks
+    uint8_t channel;
+    int8_t rssi;
+    uint16_t beacon_interval; // in time units (1.024 ms)
+    security_t security;
+    uint32_t beacons;
+    uint32_t last_seen;
+} network_entry_t;
+
+typedef struct {
+    uint8_t mac[6];
+    char last_ssid[MAX_SSID_LEN + 1]; // empty for wildcard probes
+    int8_t rssi;
+    uint32_t probes;
+    uint32_t last_seen;
+} client_entry_t;
+
+// Bounded table of access points (from beacons and probe responses) and probing clients.
+// When a table is full the entry that was seen least recently is replaced.
+class NetInventory {
+  public:
+    NetInventory() { clear(); }
+
+    void record(const mgmt_frame_info_t &info, int8_t rssi, uint8_t rx_channel, uint32_t now);
+    void clear();
+
+    size_t network_count() const { return num_networks; }
+    size_t client_count() const { return num_clients; }
+    const network_entry_t &network(size_t i) const { return networks[i]; }
+    const client_entry_t &client(size_t i) const { return clients[i]; }
+
+  private:
+    void record_network(const mgmt_frame_info_t &info, int8_t rssi, uint8_t channel,
+                        uint32_t now);
+    void record_client(const mgmt_frame_info_t &info, int8_t rssi, uint32_t now);
+
+    network_entry_t networks[INVENTORY_MAX_NETWORKS];
+    client_entry_t clients[INVENTORY_MAX_CLIENTS];
+    size_t num_networks;
+    size_t num_clients;
+};
+
+#endif /* NET_INVENTORY_H */
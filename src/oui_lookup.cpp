@@ -83,4 +83,157 @@ String findManufacturer(const char* filename, const String &oui) {
 
     Serial.println("OUI found, but not an end of a valid manufacturer prefix");
     return "";
-}
\ No newline at end of file
+}
+
+#define OUI_PREFIX_CACHE_SIZE 64
+
+static File oui_db;
+static OUIDbHeader oui_db_header;
+static uint32_t *oui_containers = nullptr;  // oui | prefix nibbles << 24, sorted by oui
+static uint32_t *oui_directory = nullptr;   // first entry of each bucket, plus an end marker
+static OUIDbEntry *oui_bucket = nullptr;    // read buffer for a single bucket
+static uint32_t oui_entries_offset = 0;
+static bool oui_db_loaded = false;
+
+std::unordered_map<uint64_t, String> cached_prefixes;
+
+bool isGroupAddress(const uint8_t *mac) {
+    return mac[0] & 0x01;
+}
+
+bool isLocallyAdministered(const uint8_t *mac) {
+    return (mac[0] & 0x03) == 0x02;
+}
+
+// FNV-1a over the little-endian bytes of the key; must match tools/oui/build_oui_db.py
+static uint32_t hashPrefixKey(uint64_t key) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 8; i++) {
+        hash = (hash ^ ((key >> (8 * i)) & 0xff)) * 16777619u;
+    }
+    return hash;
+}
+
+static void unloadOUIDatabase() {
+    oui_db_loaded = false;
+    if (oui_db) {
+        oui_db.close();
+    }
+    free(oui_containers);
+    free(oui_directory);
+    free(oui_bucket);
+    oui_containers = nullptr;
+    oui_directory = nullptr;
+    oui_bucket = nullptr;
+    cached_prefixes.clear();
+}
+
+bool loadOUIDatabase(const char *filename) {
+    unloadOUIDatabase();
+
+    oui_db = SD.open(filename, FILE_READ);
+    if (!oui_db) {
+        Serial.println("Failed to open file");
+        return false;
+    }
+
+    OUIDbHeader &header = oui_db_header;
+    if (oui_db.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != OUI_DB_MAGIC || header.version != OUI_DB_VERSION ||
+        header.bucket_count == 0 || (header.bucket_count & (header.bucket_count - 1)) != 0) {
+        Serial.println("Invalid OUI database");
+        unloadOUIDatabase();
+        return false;
+    }
+
+    size_t containers_size = header.container_count * sizeof(uint32_t);
+    size_t directory_size = (header.bucket_count + 1) * sizeof(uint32_t);
+    oui_containers = (uint32_t *)malloc(containers_size + sizeof(uint32_t));
+    oui_directory = (uint32_t *)malloc(directory_size);
+    oui_bucket = (OUIDbEntry *)malloc((header.max_bucket + 1) * sizeof(OUIDbEntry));
+    if (oui_containers == nullptr || oui_directory == nullptr || oui_bucket == nullptr) {
+        Serial.println("Not enough memory for OUI database");
+        unloadOUIDatabase();
+        return false;
+    }
+
+    if (oui_db.read((uint8_t *)oui_containers, containers_size) != containers_size ||
+        oui_db.read((uint8_t *)oui_directory, directory_size) != directory_size) {
+        Serial.println("Invalid OUI database");
+        unloadOUIDatabase();
+        return false;
+    }
+
+    oui_entries_offset = sizeof(header) + containers_size + directory_size;
+    oui_db_loaded = true;
+    Serial.printf("Loaded OUI database: %u prefixes, %u split OUIs\n", header.entry_count,
+                  header.container_count);
+    return true;
+}
+
+bool ouiDatabaseLoaded() {
+    return oui_db_loaded;
+}
+
+// Returns how many hex digits of the address make up its assigned prefix: 9 or 7 inside an
+// OUI that the registration authority split into MA-S or MA-M blocks, otherwise 6.
+static int prefixNibbles(uint32_t oui) {
+    int low = 0;
+    int high = oui_db_header.container_count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        uint32_t container_oui = oui_containers[mid] & 0xffffff;
+        if (container_oui == oui) {
+            return oui_containers[mid] >> 24;
+        } else if (container_oui < oui) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return 6;
+}
+
+String findManufacturer(const uint8_t *mac) {
+    if (!oui_db_loaded || isGroupAddress(mac) || isLocallyAdministered(mac)) {
+        return "";
+    }
+
+    uint64_t address = 0;
+    for (int i = 0; i < 6; i++) {
+        address = (address << 8) | mac[i];
+    }
+    int nibbles = prefixNibbles(address >> 24);
+    uint64_t key = ((uint64_t)nibbles << 40) | (address >> (48 - 4 * nibbles));
+
+    auto cached = cached_prefixes.find(key);
+    if (cached != cached_prefixes.end()) {
+        return cached->second;
+    }
+
+    // Only the matching bucket is read from the card
+    uint32_t bucket = hashPrefixKey(key) & (oui_db_header.bucket_count - 1);
+    uint32_t first = oui_directory[bucket];
+    uint32_t count = oui_directory[bucket + 1] - first;
+    String manufacturer = "";
+    if (count > 0 && count <= oui_db_header.max_bucket) {
+        size_t size = count * sizeof(OUIDbEntry);
+        oui_db.seek(oui_entries_offset + first * sizeof(OUIDbEntry));
+        if (oui_db.read((uint8_t *)oui_bucket, size) == size) {
+            for (uint32_t i = 0; i < count; i++) {
+                if (oui_bucket[i].key == key) {
+                    oui_bucket[i].name[OUI_DB_NAME_SIZE - 1] = '\0';
+                    manufacturer = oui_bucket[i].name;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Misses are cached too, so unknown devices do not hit the card on every frame
+    if (cached_prefixes.size() >= OUI_PREFIX_CACHE_SIZE || ESP.getFreeHeap() < 500) {
+        cached_prefixes.clear();
+    }
+    cached_prefixes[key] = manufacturer;
+    return manufacturer;
+}
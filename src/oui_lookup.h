@@ -31,4 +31,41 @@ String readManufacturerName(File &file, int32_t offset);
 // Function to navigate the trie and find the manufacturer name for the given OUI
 String findManufacturer(const char* filename, const String &oui);
 
+// Longest-prefix database covering MA-L (24-bit), MA-M (28-bit) and MA-S (36-bit)
+// assignments, built by tools/oui/build_oui_db.py. The header, the list of OUIs that are
+// split into MA-M/MA-S blocks and the bucket directory are kept in RAM, so a lookup is a
+// single read of one hash bucket from the file.
+#define OUI_DB_MAGIC 0x4c49554f  // "OUIL"
+#define OUI_DB_VERSION 1
+#define OUI_DB_NAME_SIZE 32
+
+struct OUIDbHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t reserved;
+    uint16_t container_count;  // OUIs subdivided into MA-M or MA-S blocks
+    uint32_t bucket_count;     // power of two
+    uint32_t entry_count;
+    uint32_t max_bucket;       // entries in the largest bucket
+};
+
+struct OUIDbEntry {
+    uint64_t key;                  // prefix length in nibbles << 40 | prefix value
+    char name[OUI_DB_NAME_SIZE];   // null terminated, truncated to fit
+};
+
+// Returns true for broadcast and multicast addresses, which have the group bit set
+bool isGroupAddress(const uint8_t *mac);
+
+// Returns true for locally administered (e.g. randomized) unicast addresses, which carry no OUI
+bool isLocallyAdministered(const uint8_t *mac);
+
+// Loads the index of a longest-prefix database. Returns false if the file is missing or invalid.
+bool loadOUIDatabase(const char *filename);
+
+bool ouiDatabaseLoaded();
+
+// Finds the manufacturer for the longest assigned prefix of mac, or "" if there is none
+String findManufacturer(const uint8_t *mac);
+
 #endif  // OUI_LOOKUP_H
@@ -0,0 +1,106 @@
+#ifndef SUMMARY_PROTOCOL_H
+#define SUMMARY_PROTOCOL_H
+
+// Wire format of the UDP summary stream sent by boards in station mode. Shared between
+// the firmware and the host-side collector (tools/collector), so keep it free of
+// Arduino dependencies. All multi-byte fields are little endian.
+//
+// Datagram: header followed by record_count records.
+//   header: magic u32 | version u8 | record_count u8 | board_id u8[6] | seq u32 | uptime_ms u32 |
+//           interval_ms u32
+//   record: mac u8[6] | kind u8 | channel u8 | rssi i8 | reserved u8 | frames u32
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SUMMARY_MAGIC 0x53534259 // "YBSS"
+#define SUMMARY_VERSION 2
+#define SUMMARY_DEFAULT_PORT 5005
+#define SUMMARY_FLUSH_INTERVAL_MS 1000 // how often boards send what they have seen
+
+#define SUMMARY_HEADER_LEN 24
+#define SUMMARY_RECORD_LEN 14
+#define SUMMARY_MAX_RECORDS 64
+#define SUMMARY_MAX_DATAGRAM (SUMMARY_HEADER_LEN + SUMMARY_MAX_RECORDS * SUMMARY_RECORD_LEN)
+
+// What kind of frame the device was seen sending
+#define SUMMARY_KIND_DATA 0   // transmitter of a data frame
+#define SUMMARY_KIND_AP 1     // beacon or probe response
+#define SUMMARY_KIND_CLIENT 2 // probe request
+
+typedef struct {
+    uint8_t version;
+    uint8_t record_count;
+    uint8_t board_id[6];
+    uint32_t seq;
+    uint32_t uptime_ms;
+    uint32_t interval_ms; // time the records were collected over
+} summary_header_t;
+
+typedef struct {
+    uint8_t mac[6];
+    uint8_t kind;
+    uint8_t channel;
+    int8_t rssi; // strongest RSSI seen during the interval
+    uint32_t frames;
+} summary_record_t;
+
+static inline void summary_put_le32(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = (v >> 24) & 0xff;
+}
+
+static inline uint32_t summary_get_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static inline void summary_write_header(uint8_t *buf, const summary_header_t *header) {
+    summary_put_le32(buf, SUMMARY_MAGIC);
+    buf[4] = header->version;
+    buf[5] = header->record_count;
+    memcpy(buf + 6, header->board_id, 6);
+    summary_put_le32(buf + 12, header->seq);
+    summary_put_le32(buf + 16, header->uptime_ms);
+    summary_put_le32(buf + 20, header->interval_ms);
+}
+
+static inline void summary_write_record(uint8_t *buf, const summary_record_t *record) {
+    memcpy(buf, record->mac, 6);
+    buf[6] = record->kind;
+    buf[7] = record->channel;
+    buf[8] = (uint8_t)record->rssi;
+    buf[9] = 0;
+    summary_put_le32(buf + 10, record->frames);
+}
+
+// Validates magic, version and length. Returns false if the datagram should be dropped.
+static inline bool summary_read_header(const uint8_t *buf, size_t len, summary_header_t *header) {
+    if (len < SUMMARY_HEADER_LEN || summary_get_le32(buf) != SUMMARY_MAGIC) {
+        return false;
+    }
+    header->version = buf[4];
+    header->record_count = buf[5];
+    if (header->version != SUMMARY_VERSION ||
+        len < SUMMARY_HEADER_LEN + (size_t)header->record_count * SUMMARY_RECORD_LEN) {
+        return false;
+    }
+    memcpy(header->board_id, buf + 6, 6);
+    header->seq = summary_get_le32(buf + 12);
+    header->uptime_ms = summary_get_le32(buf + 16);
+    header->interval_ms = summary_get_le32(buf + 20);
+    return true;
+}
+
+static inline void summary_read_record(const uint8_t *buf, summary_record_t *record) {
+    memcpy(record->mac, buf, 6);
+    record->kind = buf[6];
+    record->channel = buf[7];
+    record->rssi = (int8_t)buf[8];
+    record->frames = summary_get_le32(buf + 10);
+}
+
+#endif /* SUMMARY_PROTOCOL_H */
@@ -0,0 +1,130 @@
+#include "summary_stream.h"
+#include <Arduino.h>
+
+static inline uint32_t hash_mac(const uint8_t *mac) {
+    // FNV-1a over the six address bytes
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < 6; i++) {
+        hash = (hash ^ mac[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void SummaryStream::begin(const char *host, uint16_t port, const uint8_t board_id[6]) {
+    this->host = host;
+    this->port = port;
+    memcpy(this->board_id, board_id, 6);
+    memset(tables, 0, sizeof(tables));
+    table_fill[0] = table_fill[1] = 0;
+    active_table = 0;
+    dropped = 0;
+    seq = 0;
+    last_flush_ms = millis();
+    udp.begin(0);
+    enabled = true;
+}
+
+void SummaryStream::end() {
+    enabled = false;
+    udp.stop();
+}
+
+void SummaryStream::record(const uint8_t *mac, uint8_t kind, uint8_t channel, int8_t rssi) {
+    portENTER_CRITICAL(&mux);
+    sighting_t *table = tables[active_table];
+    uint32_t slot = hash_mac(mac) & (SUMMARY_TABLE_SIZE - 1);
+
+    // Linear probing; the table is never allowed to fill up, so this always terminates
+    while (table[slot].used && memcmp(table[slot].mac, mac, 6) != 0) {
+        slot = (slot + 1) & (SUMMARY_TABLE_SIZE - 1);
+    }
+
+    sighting_t *entry = &table[slot];
+    if (!entry->used) {
+        if (table_fill[active_table] >= SUMMARY_TABLE_MAX_FILL) {
+            dropped++;
+            portEXIT_CRITICAL(&mux);
+            return;
+        }
+        memcpy(entry->mac, mac, 6);
+        entry->used = true;
+        entry->kind = kind;
+        entry->rssi = rssi;
+        entry->frames = 0;
+        table_fill[active_table]++;
+    }
+    // Beacons and probes say more about what a device is than the data frames it sends
+    if (kind != SUMMARY_KIND_DATA && entry->kind != SUMMARY_KIND_AP) {
+        entry->kind = kind;
+    }
+    if (rssi > entry->rssi) {
+        entry->rssi = rssi;
+    }
+    entry->channel = channel;
+    entry->frames++;
+    portEXIT_CRITICAL(&mux);
+}
+
+void SummaryStream::flush() {
+    if (!enabled) {
+        return;
+    }
+
+    portENTER_CRITICAL(&mux);
+    uint8_t full_table = active_table;
+    active_table ^= 1;
+    uint32_t dropped_now = dropped;
+    dropped = 0;
+    uint32_t now = millis();
+    uint32_t interval_ms = now - last_flush_ms;
+    last_flush_ms = now;
+    portEXIT_CRITICAL(&mux);
+
+    if (dropped_now) {
+        Serial.printf("Summary table full, dropped %lu sightings\n", (unsigned long)dropped_now);
+    }
+
+    sighting_t *table = tables[full_table];
+    uint8_t record_count = 0;
+    for (int i = 0; i < SUMMARY_TABLE_SIZE; i++) {
+        if (!table[i].used) {
+            continue;
+        }
+        summary_record_t record;
+        memcpy(record.mac, table[i].mac, 6);
+        record.kind = table[i].kind;
+        record.channel = table[i].channel;
+        record.rssi = table[i].rssi;
+        record.frames = table[i].frames;
+        summary_write_record(datagram + SUMMARY_HEADER_LEN + record_count * SUMMARY_RECORD_LEN,
+                             &record);
+        table[i].used = false;
+
+        if (++record_count == SUMMARY_MAX_RECORDS) {
+            send_batch(record_count, interval_ms);
+            record_count = 0;
+        }
+    }
+    if (record_count > 0) {
+        send_batch(record_count, interval_ms);
+    }
+    table_fill[full_table] = 0;
+}
+
+void SummaryStream::send_batch(uint8_t record_count, uint32_t interval_ms) {
+    summary_header_t header;
+    header.version = SUMMARY_VERSION;
+    header.record_count = record_count;
+    memcpy(header.board_id, board_id, 6);
+    header.seq = seq++;
+    header.uptime_ms = millis();
+    header.interval_ms = interval_ms;
+    summary_write_header(datagram, &header);
+
+    if (!udp.beginPacket(host, port)) {
+        Serial.printf("Summary stream: could not resolve %s\n", host);
+        return;
+    }
+    udp.write(datagram, SUMMARY_HEADER_LEN + record_count * SUMMARY_RECORD_LEN);
+    udp.endPacket();
+}
@@ -0,0 +1,60 @@
+#ifndef SUMMARY_STREAM_H
+#define SUMMARY_STREAM_H
+
+#include <WiFiUdp.h>
+#include <stdint.h>
+
+#include "summary_protocol.h"
+
+// Open-addressed table of devices seen since the last flush. Must be a power of two.
+#define SUMMARY_TABLE_SIZE 256
+#define SUMMARY_TABLE_MAX_FILL 192
+
+typedef struct {
+    uint8_t mac[6];
+    uint8_t kind;
+    uint8_t channel;
+    int8_t rssi;
+    bool used;
+    uint32_t frames;
+} sighting_t;
+
+// Accumulates device sightings from the sniffer callback and periodically sends them to a
+// collector as batched UDP datagrams (see summary_protocol.h).
+//
+// The callback and the flushing task each own one of two tables; flush() swaps them under a
+// spinlock so the callback never waits on the network. Each datagram carries the time since
+// the previous swap, so the collector can turn frame counts into rates.
+class SummaryStream {
+  public:
+    void begin(const char *host, uint16_t port, const uint8_t board_id[6]);
+    void end();
+    bool active() const { return enabled; }
+
+    // Called from the WiFi task
+    void record(const uint8_t *mac, uint8_t kind, uint8_t channel, int8_t rssi);
+
+    // Called every SUMMARY_FLUSH_INTERVAL_MS. Sends everything recorded since the previous flush.
+    void flush();
+
+  private:
+    void send_batch(uint8_t record_count, uint32_t interval_ms);
+
+    WiFiUDP udp;
+    const char *host = nullptr;
+    uint16_t port = SUMMARY_DEFAULT_PORT;
+    uint8_t board_id[6] = {0};
+    uint32_t seq = 0;
+    uint32_t last_flush_ms = 0;
+    bool enabled = false;
+
+    sighting_t tables[2][SUMMARY_TABLE_SIZE];
+    uint16_t table_fill[2] = {0, 0};
+    uint32_t dropped = 0;
+    uint8_t active_table = 0;
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+    uint8_t datagram[SUMMARY_MAX_DATAGRAM];
+};
+
+#endif /* SUMMARY_STREAM_H */
@@ -0,0 +1,452 @@
+// Host-side collector for the board summary stream (see src/summary_protocol.h).
+//
+// Listen mode merges datagrams from any number of boards, tracks per-board sequence
+// numbers to count lost datagrams, and deduplicates devices by MAC address across boards.
+// Simulate mode stands in for a set of boards so the collector can be exercised on
+// localhost without hardware.
+//
+//   collector [--port N] [--interval SECONDS] [--top N]
+//   collector --simulate BOARDS [--host ADDR] [--port N] [--rate RECORDS_PER_SEC]
+//             [--devices N] [--duration SECONDS] [--loss PERCENT]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "summary_protocol.h"
+
+#define RECV_BATCH 64
+#define MAX_BOARDS 64
+
+using Clock = std::chrono::steady_clock;
+
+static uint64_t mac_to_u64(const uint8_t *mac) {
+    uint64_t value = 0;
+    for (int i = 0; i < 6; i++) {
+        value = (value << 8) | mac[i];
+    }
+    return value;
+}
+
+static std::string mac_to_string(uint64_t mac) {
+    char buf[18];
+    snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", (unsigned)(mac >> 40) & 0xff,
+             (unsigned)(mac >> 32) & 0xff, (unsigned)(mac >> 24) & 0xff,
+             (unsigned)(mac >> 16) & 0xff, (unsigned)(mac >> 8) & 0xff, (unsigned)mac & 0xff);
+    return buf;
+}
+
+static const char *kind_name(uint8_t kind) {
+    switch (kind) {
+    case SUMMARY_KIND_AP:
+        return "ap";
+    case SUMMARY_KIND_CLIENT:
+        return "client";
+    default:
+        return "data";
+    }
+}
+
+typedef struct {
+    int index;
+    uint32_t last_seq;
+    uint32_t last_uptime_ms;
+    uint32_t interval_ms; // collection interval of the latest datagram
+    bool have_seq;
+    uint64_t datagrams;
+    uint64_t records;
+    uint64_t lost;
+    uint64_t duplicates;
+    uint64_t restarts;
+    Clock::time_point last_heard;
+} board_state_t;
+
+typedef struct {
+    uint8_t kind;
+    uint8_t channel;
+    int8_t best_rssi;    // strongest RSSI reported for the device
+    int best_board;      // index of the board that reported best_rssi
+    uint64_t board_mask; // boards that have seen the device
+    // Boards with overlapping coverage hear the same frames, so counts are kept per board
+    // (indexed by board index) and the device is credited with the largest one
+    std::vector<uint64_t> board_frames;
+    uint64_t frames;
+    Clock::time_point first_seen;
+    Clock::time_point last_seen;
+} device_state_t;
+
+class Collector {
+  public:
+    Collector() { devices.reserve(1 << 16); }
+
+    void handle_datagram(const uint8_t *buf, size_t len, Clock::time_point now);
+    void report(double elapsed_s, int top);
+
+  private:
+    bool accept_seq(board_state_t &board, const summary_header_t &header);
+
+    std::unordered_map<uint64_t, board_state_t> boards;
+    std::vector<uint64_t> board_ids; // board index -> board id
+    std::unordered_map<uint64_t, device_state_t> devices;
+    uint64_t interval_records = 0;
+    uint64_t interval_datagrams = 0;
+    uint64_t rejected = 0;
+};
+
+// Returns false for duplicated or reordered datagrams, which are dropped. A board that
+// restarts begins again at sequence 0, which is detected by its uptime going backwards.
+bool Collector::accept_seq(board_state_t &board, const summary_header_t &header) {
+    if (board.have_seq && header.uptime_ms + 1000 < board.last_uptime_ms) {
+        board.restarts++;
+        board.have_seq = false;
+    }
+    if (board.have_seq) {
+        uint32_t delta = header.seq - board.last_seq;
+        if (delta == 0 || delta > 0x80000000u) {
+            board.duplicates++;
+            return false;
+        }
+        board.lost += delta - 1;
+    }
+    board.have_seq = true;
+    board.last_seq = header.seq;
+    board.last_uptime_ms = header.uptime_ms;
+    return true;
+}
+
+void Collector::handle_datagram(const uint8_t *buf, size_t len, Clock::time_point now) {
+    summary_header_t header;
+    if (!summary_read_header(buf, len, &header)) {
+        rejected++;
+        return;
+    }
+
+    uint64_t board_id = mac_to_u64(header.board_id);
+    auto found = boards.find(board_id);
+    if (found == boards.end()) {
+        board_state_t state = {};
+        state.index = (int)board_ids.size();
+        board_ids.push_back(board_id);
+        found = boards.emplace(board_id, state).first;
+    }
+    board_state_t &board = found->second;
+    board.last_heard = now;
+    if (!accept_seq(board, header)) {
+        return;
+    }
+    board.datagrams++;
+    board.records += header.record_count;
+    board.interval_ms = header.interval_ms;
+    interval_datagrams++;
+    interval_records += header.record_count;
+
+    uint64_t board_bit = board.index < MAX_BOARDS ? (1ull << board.index) : 0;
+    const uint8_t *p = buf + SUMMARY_HEADER_LEN;
+    for (int i = 0; i < header.record_count; i++, p += SUMMARY_RECORD_LEN) {
+        summary_record_t record;
+        summary_read_record(p, &record);
+
+        auto inserted = devices.try_emplace(mac_to_u64(record.mac));
+        device_state_t &device = inserted.first->second;
+        if (inserted.second) {
+            device.kind = record.kind;
+            device.best_rssi = record.rssi;
+            device.best_board = board.index;
+            device.board_mask = 0;
+            device.frames = 0;
+            device.first_seen = now;
+        }
+        if (record.kind != SUMMARY_KIND_DATA && device.kind != SUMMARY_KIND_AP) {
+            device.kind = record.kind;
+        }
+        // The closest board is whichever reports the strongest signal. Let the same board
+        // lower its own reading so a device that moves away is not pinned forever.
+        if (record.rssi >= device.best_rssi || device.best_board == board.index) {
+            device.best_rssi = record.rssi;
+            device.best_board = board.index;
+        }
+        device.channel = record.channel;
+        device.board_mask |= board_bit;
+        if (device.board_frames.size() <= (size_t)board.index) {
+            device.board_frames.resize(board.index + 1);
+        }
+        uint64_t board_frames = device.board_frames[board.index] += record.frames;
+        device.frames = std::max(device.frames, board_frames);
+        device.last_seen = now;
+    }
+}
+
+void Collector::report(double elapsed_s, int top) {
+    Clock::time_point now = Clock::now();
+    size_t active = 0;
+    for (const auto &entry : devices) {
+        if (now - entry.second.last_seen < std::chrono::seconds(60)) {
+            active++;
+        }
+    }
+
+    printf("\n%.0f records/s, %.0f datagrams/s, %zu boards, %zu devices (%zu active in 60s)",
+           interval_records / elapsed_s, interval_datagrams / elapsed_s, boards.size(),
+           devices.size(), active);
+    if (rejected) {
+        printf(", %llu rejected", (unsigned long long)rejected);
+    }
+    printf("\n");
+    interval_records = 0;
+    interval_datagrams = 0;
+
+    for (uint64_t board_id : board_ids) {
+        const board_state_t &board = boards[board_id];
+        double age = std::chrono::duration<double>(now - board.last_heard).count();
+        printf("  board %2d %s  datagrams %8llu  records %10llu  lost %6llu  dup %4llu  "
+               "restarts %llu  interval %.1fs  last %.1fs ago\n",
+               board.index, mac_to_string(board_id).c_str(),
+               (unsigned long long)board.datagrams, (unsigned long long)board.records,
+               (unsigned long long)board.lost, (unsigned long long)board.duplicates,
+               (unsigned long long)board.restarts, board.interval_ms / 1000.0, age);
+    }
+
+    if (top <= 0 || devices.empty()) {
+        fflush(stdout);
+        return;
+    }
+    std::vector<std::pair<uint64_t, const device_state_t *>> sorted;
+    sorted.reserve(devices.size());
+    for (const auto &entry : devices) {
+        sorted.emplace_back(entry.first, &entry.second);
+    }
+    size_t count = std::min(sorted.size(), (size_t)top);
+    std::partial_sort(
+        sorted.begin(), sorted.begin() + count, sorted.end(),
+        [](const auto &a, const auto &b) { return a.second->frames > b.second->frames; });
+    printf("  %-17s  %-6s  %2s  %4s  %5s  %6s  %s\n", "DEVICE", "KIND", "CH", "RSSI", "NEAR",
+           "BOARDS", "FRAMES");
+    for (size_t i = 0; i < count; i++) {
+        const device_state_t &device = *sorted[i].second;
+        printf("  %-17s  %-6s  %2u  %4d  %5d  %6d  %llu\n",
+               mac_to_string(sorted[i].first).c_str(), kind_name(device.kind), device.channel,
+               device.best_rssi, device.best_board,
+               __builtin_popcountll(device.board_mask), (unsigned long long)device.frames);
+    }
+    fflush(stdout);
+}
+
+static int run_collector(uint16_t port, double interval_s, int top) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        perror("socket");
+        return 1;
+    }
+    int rcvbuf = 8 << 20;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(sock, (sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(sock);
+        return 1;
+    }
+    printf("Listening for summary streams on UDP port %u\n", port);
+
+    // Receive datagrams in batches to keep the per-datagram syscall cost down
+    static uint8_t buffers[RECV_BATCH][SUMMARY_MAX_DATAGRAM];
+    mmsghdr messages[RECV_BATCH];
+    iovec iovecs[RECV_BATCH];
+    for (int i = 0; i < RECV_BATCH; i++) {
+        iovecs[i].iov_base = buffers[i];
+        iovecs[i].iov_len = sizeof(buffers[i]);
+        messages[i] = {};
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    Collector collector;
+    Clock::time_point last_report = Clock::now();
+    auto interval = std::chrono::duration<double>(interval_s);
+    while (true) {
+        pollfd pfd = {sock, POLLIN, 0};
+        poll(&pfd, 1, 100);
+
+        if (pfd.revents & POLLIN) {
+            int received = recvmmsg(sock, messages, RECV_BATCH, MSG_DONTWAIT, nullptr);
+            Clock::time_point now = Clock::now();
+            for (int i = 0; i < received; i++) {
+                collector.handle_datagram(buffers[i], messages[i].msg_len, now);
+            }
+        }
+
+        Clock::time_point now = Clock::now();
+        if (now - last_report >= interval) {
+            collector.report(std::chrono::duration<double>(now - last_report).count(), top);
+            last_report = now;
+        }
+    }
+}
+
+// Pretends to be several boards that share a pool of devices, so some devices are
+// reported by more than one board and must be merged by the collector.
+static int run_simulator(int board_count, const char *host, uint16_t port, double rate,
+                         int device_count, double duration_s, double loss_percent) {
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        perror("socket");
+        return 1;
+    }
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid address: %s\n", host);
+        close(sock);
+        return 1;
+    }
+
+    std::mt19937 rng(1234);
+    std::vector<std::array<uint8_t, 6>> device_macs(device_count);
+    for (auto &mac : device_macs) {
+        for (auto &byte : mac) {
+            byte = rng() & 0xff;
+        }
+        mac[0] &= 0xfe; // unicast
+    }
+
+    std::vector<uint32_t> seqs(board_count, 0);
+    std::uniform_int_distribution<int> pick_device(0, device_count - 1);
+    std::uniform_int_distribution<int> pick_rssi(-90, -30);
+    std::uniform_real_distribution<double> chance(0.0, 100.0);
+
+    // Each datagram carries a full batch; pace them to hit the requested record rate
+    auto datagram_period = std::chrono::duration<double>(SUMMARY_MAX_RECORDS / rate);
+    Clock::time_point start = Clock::now();
+    Clock::time_point next_send = start;
+    uint64_t sent = 0;
+    uint64_t dropped = 0;
+    uint8_t datagram[SUMMARY_MAX_DATAGRAM];
+
+    printf("Simulating %d boards -> %s:%u at %.0f records/s\n", board_count, host, port, rate);
+    while (duration_s <= 0 ||
+           Clock::now() - start < std::chrono::duration<double>(duration_s)) {
+        int board = (int)(sent % board_count);
+
+        summary_header_t header;
+        header.version = SUMMARY_VERSION;
+        header.record_count = SUMMARY_MAX_RECORDS;
+        uint8_t board_id[6] = {0x02, 0x59, 0x42, 0x00, (uint8_t)(board >> 8), (uint8_t)board};
+        memcpy(header.board_id, board_id, 6);
+        header.seq = seqs[board]++;
+        header.uptime_ms = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                               Clock::now() - start)
+                               .count();
+        header.interval_ms = SUMMARY_FLUSH_INTERVAL_MS;
+        summary_write_header(datagram, &header);
+
+        for (int i = 0; i < SUMMARY_MAX_RECORDS; i++) {
+            summary_record_t record;
+            int device = pick_device(rng);
+            memcpy(record.mac, device_macs[device].data(), 6);
+            record.kind = device % 10 == 0 ? SUMMARY_KIND_AP : SUMMARY_KIND_DATA;
+            record.channel = 1 + device % 11;
+            record.rssi = (int8_t)pick_rssi(rng);
+            record.frames = 1 + rng() % 50;
+            summary_write_record(datagram + SUMMARY_HEADER_LEN + i * SUMMARY_RECORD_LEN, &record);
+        }
+
+        if (chance(rng) >= loss_percent) {
+            sendto(sock, datagram, SUMMARY_MAX_DATAGRAM, 0, (sockaddr *)&addr, sizeof(addr));
+        } else {
+            dropped++;
+        }
+        sent++;
+
+        next_send += std::chrono::duration_cast<Clock::duration>(datagram_period);
+        std::this_thread::sleep_until(next_send);
+    }
+
+    printf("Sent %llu datagrams (%llu records), dropped %llu on purpose\n",
+           (unsigned long long)(sent - dropped),
+           (unsigned long long)((sent - dropped) * SUMMARY_MAX_RECORDS),
+           (unsigned long long)dropped);
+    close(sock);
+    return 0;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "Usage: %s [--port N] [--interval SECONDS] [--top N]\n"
+            "       %s --simulate BOARDS [--host ADDR] [--port N] [--rate RECORDS_PER_SEC]\n"
+            "          [--devices N] [--duration SECONDS] [--loss PERCENT]\n",
+            name, name);
+}
+
+int main(int argc, char **argv) {
+    uint16_t port = SUMMARY_DEFAULT_PORT;
+    double interval_s = 5.0;
+    int top = 10;
+    int simulate = 0;
+    const char *host = "127.0.0.1";
+    double rate = 20000;
+    int device_count = 5000;
+    double duration_s = 0;
+    double loss_percent = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char *value = argv[++i];
+        if (arg == "--port") {
+            port = (uint16_t)atoi(value);
+        } else if (arg == "--interval") {
+            interval_s = atof(value);
+        } else if (arg == "--top") {
+            top = atoi(value);
+        } else if (arg == "--simulate") {
+            simulate = atoi(value);
+        } else if (arg == "--host") {
+            host = value;
+        } else if (arg == "--rate") {
+            rate = atof(value);
+        } else if (arg == "--devices") {
+            device_count = atoi(value);
+        } else if (arg == "--duration") {
+            duration_s = atof(value);
+        } else if (arg == "--loss") {
+            loss_percent = atof(value);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (simulate > 0) {
+        if (rate <= 0 || device_count <= 0) {
+            usage(argv[0]);
+            return 1;
+        }
+        return run_simulator(simulate, host, port, rate, device_count, duration_s, loss_percent);
+    }
+    if (interval_s <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    return run_collector(port, interval_s, top);
+}
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""Builds the longest-prefix OUI database read by src/oui_lookup.cpp.
+
+Takes the IEEE registry CSV exports (https://standards-oui.ieee.org):
+  oui.csv    MA-L, 24-bit prefixes
+  mam.csv    MA-M, 28-bit prefixes
+  oui36.csv  MA-S, 36-bit prefixes
+
+and writes a little-endian file laid out as:
+
+  header      magic "OUIL" | version u8 | reserved u8 | container_count u16 |
+              bucket_count u32 | entry_count u32 | max_bucket u32
+  containers  container_count x u32: oui | prefix nibbles << 24, sorted by oui
+  directory   (bucket_count + 1) x u32: index of the first entry in each bucket
+  entries     entry_count x (key u64 | name char[32]), grouped by bucket
+
+A container is an OUI the registration authority split into MA-M or MA-S blocks. The
+firmware keeps the containers and directory in RAM, works out the prefix length from the
+container list, and then reads only the one bucket that can hold the key. An address in
+a container whose block is unassigned is reported as unknown.
+
+Usage:
+  build_oui_db.py oui.csv mam.csv oui36.csv -o ouis.lpm
+  build_oui_db.py --lookup 70:B3:D5:12:34:56 ouis.lpm
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+MAGIC = 0x4C49554F  # "OUIL"
+VERSION = 1
+NAME_SIZE = 32
+HEADER = struct.Struct("<IBBHIII")
+ENTRY = struct.Struct("<Q%ds" % NAME_SIZE)
+# Target average bucket size; keeps the directory small and each bucket one short read
+ENTRIES_PER_BUCKET = 12
+
+
+def prefix_key(nibbles, value):
+    return (nibbles << 40) | value
+
+
+def hash_key(key):
+    """FNV-1a over the little-endian bytes of the key, as in hashPrefixKey()."""
+    h = 2166136261
+    for byte in key.to_bytes(8, "little"):
+        h = ((h ^ byte) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def encode_name(name):
+    data = name.strip().encode("utf-8")[: NAME_SIZE - 1]
+    # Do not leave half of a multi-byte character at the end
+    return data.decode("utf-8", "ignore").rstrip().encode("utf-8")
+
+
+def read_registry(path):
+    assignments = []
+    with open(path, newline="", encoding="utf-8") as f:
+        for row in csv.DictReader(f):
+            assignment = row["Assignment"].strip().upper()
+            assignments.append((assignment, row["Organization Name"]))
+    return assignments
+
+
+def build(paths, output):
+    prefixes = {}
+    for path in paths:
+        for assignment, name in read_registry(path):
+            if len(assignment) not in (6, 7, 9):
+                sys.exit("%s: unexpected assignment %r" % (path, assignment))
+            prefixes[assignment] = name
+
+    containers = {}
+    for assignment in prefixes:
+        if len(assignment) == 6:
+            continue
+        oui = int(assignment[:6], 16)
+        nibbles = containers.setdefault(oui, len(assignment))
+        if nibbles != len(assignment):
+            sys.exit("OUI %06X mixes MA-M and MA-S blocks" % oui)
+
+    bucket_count = 1
+    while bucket_count * ENTRIES_PER_BUCKET < len(prefixes):
+        bucket_count *= 2
+
+    buckets = [[] for _ in range(bucket_count)]
+    for assignment, name in prefixes.items():
+        # MA-L entries for split OUIs belong to the registration authority and can
+        # never be reached, since those addresses are looked up by their longer prefix
+        if len(assignment) == 6 and int(assignment, 16) in containers:
+            continue
+        key = prefix_key(len(assignment), int(assignment, 16))
+        buckets[hash_key(key) & (bucket_count - 1)].append((key, encode_name(name)))
+
+    entry_count = sum(len(b) for b in buckets)
+    max_bucket = max(len(b) for b in buckets)
+    with open(output, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, 0, len(containers), bucket_count, entry_count,
+                            max_bucket))
+        for oui in sorted(containers):
+            f.write(struct.pack("<I", oui | containers[oui] << 24))
+        first = 0
+        for bucket in buckets:
+            f.write(struct.pack("<I", first))
+            first += len(bucket)
+        f.write(struct.pack("<I", first))
+        for bucket in buckets:
+            for key, name in sorted(bucket):
+                f.write(ENTRY.pack(key, name))
+
+    print("%d prefixes, %d split OUIs, %d buckets (largest %d)" %
+          (entry_count, len(containers), bucket_count, max_bucket))
+
+
+def lookup(path, mac):
+    """Looks up a MAC address the same way the firmware does."""
+    address = int(mac.replace(":", "").replace("-", ""), 16)
+    first_octet = address >> 40
+    if first_octet & 0x01:
+        return "Broadcast" if address == 0xFFFFFFFFFFFF else "Multicast"
+    if first_octet & 0x02:
+        return "Randomized MAC"
+    with open(path, "rb") as f:
+        magic, version, _, container_count, bucket_count, _, _ = HEADER.unpack(
+            f.read(HEADER.size))
+        if magic != MAGIC or version != VERSION:
+            sys.exit("%s: not an OUI database" % path)
+        containers = {}
+        for _ in range(container_count):
+            (value,) = struct.unpack("<I", f.read(4))
+            containers[value & 0xFFFFFF] = value >> 24
+        directory = struct.unpack("<%dI" % (bucket_count + 1), f.read(4 * (bucket_count + 1)))
+        entries_offset = f.tell()
+
+        nibbles = containers.get(address >> 24, 6)
+        key = prefix_key(nibbles, address >> (48 - 4 * nibbles))
+        bucket = hash_key(key) & (bucket_count - 1)
+        first, end = directory[bucket], directory[bucket + 1]
+        f.seek(entries_offset + first * ENTRY.size)
+        data = f.read((end - first) * ENTRY.size)
+        for i in range(end - first):
+            entry_key, name = ENTRY.unpack_from(data, i * ENTRY.size)
+            if entry_key == key:
+                return name.rstrip(b"\0").decode("utf-8")
+    return ""
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("inputs", nargs="+", help="registry CSV files, or the database with --lookup")
+    parser.add_argument("-o", "--output", default="ouis.lpm")
+    parser.add_argument("--lookup", metavar="MAC", help="look up an address in a built database")
+    args = parser.parse_args()
+
+    if args.lookup:
+        print(lookup(args.inputs[0], args.lookup) or "unknown")
+    else:
+        build(args.inputs, args.output)
+
+
+if __name__ == "__main__":
+    main()
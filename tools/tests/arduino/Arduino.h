@@ -0,0 +1,33 @@
+#ifndef ARDUINO_SHIM_H
+#define ARDUINO_SHIM_H
+
+// Just enough of the Arduino core to build src/oui_lookup.cpp on the host
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+class String : public std::string {
+  public:
+    String() {}
+    String(const char *s) : std::string(s) {}
+    String(const std::string &s) : std::string(s) {}
+    char charAt(size_t i) const { return (*this)[i]; }
+};
+
+struct SerialShim {
+    void println(const char *s) { puts(s); }
+    template <typename... Args> void printf(const char *format, Args... args) {
+        ::printf(format, args...);
+    }
+};
+inline SerialShim Serial;
+
+struct EspShim {
+    uint32_t getFreeHeap() { return 100000; }
+};
+inline EspShim ESP;
+
+#endif /* ARDUINO_SHIM_H */
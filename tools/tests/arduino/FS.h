@@ -0,0 +1,36 @@
+#ifndef FS_SHIM_H
+#define FS_SHIM_H
+
+#include "Arduino.h"
+
+#define FILE_READ "rb"
+
+// Wraps stdio and counts reads, so tests can check how often a lookup touches the card
+class File {
+  public:
+    explicit operator bool() const { return f != nullptr; }
+    void close() {
+        if (f) {
+            fclose(f);
+        }
+        f = nullptr;
+    }
+    bool seek(uint32_t pos) { return fseek(f, pos, SEEK_SET) == 0; }
+    size_t read(uint8_t *buf, size_t size) {
+        reads++;
+        return fread(buf, 1, size, f);
+    }
+    String readStringUntil(char terminator) {
+        String s;
+        int c;
+        while ((c = fgetc(f)) != EOF && c != terminator) {
+            s += (char)c;
+        }
+        return s;
+    }
+
+    FILE *f = nullptr;
+    static inline int reads = 0;
+};
+
+#endif /* FS_SHIM_H */
@@ -0,0 +1,15 @@
+#ifndef SD_SHIM_H
+#define SD_SHIM_H
+
+#include "FS.h"
+
+struct SDShim {
+    File open(const char *path, const char *mode) {
+        File file;
+        file.f = fopen(path, mode);
+        return file;
+    }
+};
+inline SDShim SD;
+
+#endif /* SD_SHIM_H */
@@ -0,0 +1,34 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+// Minimal assertion helper for the host-side tests. Failures are reported and counted,
+// and each test program returns the count as its exit status.
+
+#include <stdio.h>
+
+static int check_failures = 0;
+
+#define CHECK(cond)                                                                        \
+    do {                                                                                   \
+        if (!(cond)) {                                                                     \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);      \
+            check_failures++;                                                              \
+        }                                                                                  \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                     \
+    do {                                                                                   \
+        long long check_a = (long long)(a), check_b = (long long)(b);                      \
+        if (check_a != check_b) {                                                          \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__,    \
+                    __LINE__, #a, #b, check_a, check_b);                                   \
+            check_failures++;                                                              \
+        }                                                                                  \
+    } while (0)
+
+static inline int check_report(const char *name) {
+    printf("%s: %s\n", name, check_failures ? "FAILED" : "ok");
+    return check_failures ? 1 : 0;
+}
+
+#endif /* CHECK_H */
@@ -0,0 +1,218 @@
+// Host-side checks for src/metric_store.cpp: sample encoding round trips, ring wrap and
+// flush bookkeeping, and query windowing.
+
+#include <random>
+#include <string.h>
+#include <vector>
+
+#include "check.h"
+#include "metric_store.h"
+
+typedef struct {
+    uint32_t time;
+    int32_t value;
+} point_t;
+
+static void collect(uint32_t time, int32_t value, void *ctx) {
+    ((std::vector<point_t> *)ctx)->push_back({time, value});
+}
+
+static metric_sample_t random_sample(std::mt19937 &rng, uint32_t time) {
+    metric_sample_t sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.time = time;
+    for (int ch = 0; ch < TS_CHANNELS; ch++) {
+        // Leave some channels empty so the channel mask is exercised
+        if (rng() % 3 == 0) {
+            continue;
+        }
+        channel_metrics_t &cur = sample.channels[ch];
+        cur.frames = 1 + rng() % 2000;
+        cur.bytes = rng();
+        cur.devices = rng() % 300;
+        cur.rssi = -(int32_t)(rng() % 100);
+    }
+    return sample;
+}
+
+// Decodes every block still in the ring, oldest first
+static std::vector<point_t> read_ring(const MetricRing &ring, const metric_query_t &query) {
+    std::vector<point_t> points;
+    metric_query_t q = query;
+    q.emit = collect;
+    q.ctx = &points;
+    ts_block_t block;
+    for (uint32_t seq = ring.first_sequence(); ring.copy_block(seq, &block); seq++) {
+        query_block(block.header, block.data, q);
+    }
+    return points;
+}
+
+static void test_round_trip() {
+    static ts_block_t blocks[64];
+    MetricRing ring(blocks, 64);
+    std::mt19937 rng(1);
+    std::vector<metric_sample_t> samples;
+    for (uint32_t t = 1000; t < 1300; t += 1 + rng() % 3) {
+        samples.push_back(random_sample(rng, t));
+        ring.append(samples.back());
+    }
+
+    for (uint8_t ch = 1; ch <= TS_CHANNELS; ch++) {
+        for (int m = 0; m < METRIC_COUNT; m++) {
+            metric_query_t query = {(metric_t)m, ch, 0, UINT32_MAX, nullptr, nullptr};
+            std::vector<point_t> points = read_ring(ring, query);
+
+            size_t i = 0;
+            for (const metric_sample_t &sample : samples) {
+                const channel_metrics_t &cur = sample.channels[ch - 1];
+                // RSSI is only reported for channels that had frames
+                if (m == METRIC_RSSI && cur.frames == 0) {
+                    continue;
+                }
+                int32_t expected = m == METRIC_FRAMES  ? (int32_t)cur.frames
+                                   : m == METRIC_BYTES ? (int32_t)cur.bytes
+                                   : m == METRIC_DEVICES ? (int32_t)cur.devices
+                                                         : cur.rssi;
+                CHECK(i < points.size());
+                if (i < points.size()) {
+                    CHECK_EQ(points[i].time, sample.time);
+                    CHECK_EQ(points[i].value, expected);
+                }
+                i++;
+            }
+            CHECK_EQ(points.size(), i);
+        }
+    }
+}
+
+static void test_wrap_and_flush() {
+    static ts_block_t blocks[4];
+    MetricRing ring(blocks, 4);
+    CHECK(ring.empty());
+    CHECK(ring.pop_unflushed() == nullptr);
+
+    metric_sample_t sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.channels[0].frames = 1;
+
+    // One sample per block, closing each one; only closed blocks are handed out
+    for (uint32_t t = 1; t <= 3; t++) {
+        sample.time = t;
+        ring.append(sample);
+        ring.close_block();
+    }
+    for (uint32_t t = 1; t <= 3; t++) {
+        const ts_block_t *block = ring.pop_unflushed();
+        CHECK(block != nullptr);
+        if (block != nullptr) {
+            CHECK_EQ(block->header.start_time, t);
+        }
+    }
+    CHECK(ring.pop_unflushed() == nullptr);
+
+    // Overrun the ring without flushing; blocks overwritten before a flush are skipped
+    for (uint32_t t = 4; t <= 10; t++) {
+        sample.time = t;
+        ring.append(sample);
+        ring.close_block();
+    }
+    uint32_t expected = 8; // blocks 8, 9, 10 survive next to the empty current block
+    for (const ts_block_t *block; (block = ring.pop_unflushed()) != nullptr; expected++) {
+        CHECK_EQ(block->header.start_time, expected);
+    }
+    CHECK_EQ(expected, 11);
+    CHECK_EQ(ring.oldest_time(), 8);
+
+    ts_block_t copy;
+    CHECK(!ring.copy_block(ring.first_sequence() - 1, &copy));
+    CHECK(ring.copy_block(ring.first_sequence(), &copy));
+    CHECK_EQ(copy.header.start_time, 8);
+
+    // A full block starts a new one on its own
+    static ts_block_t more[2];
+    MetricRing small(more, 2);
+    for (uint32_t t = 0; t < 1000; t++) {
+        sample.time = t;
+        small.append(sample);
+    }
+    CHECK(small.pop_unflushed() != nullptr);
+    CHECK(small.bytes_used() <= 2 * TS_BLOCK_DATA);
+}
+
+static void test_query_window() {
+    static ts_block_t blocks[8];
+    MetricRing ring(blocks, 8);
+    metric_sample_t sample;
+    memset(&sample, 0, sizeof(sample));
+    for (uint32_t t = 100; t < 200; t++) {
+        sample.time = t;
+        sample.channels[5].frames = t;
+        sample.channels[6].frames = 2 * t;
+        sample.channels[6].rssi = -50;
+        sample.channels[5].rssi = t < 150 ? -80 : 0;
+        ring.append(sample);
+        if (t % 25 == 0) {
+            ring.close_block();
+        }
+    }
+
+    // Window bounds are inclusive and cut across block boundaries
+    metric_query_t query = {METRIC_FRAMES, 0, 120, 160, nullptr, nullptr};
+    std::vector<point_t> points = read_ring(ring, query);
+    CHECK_EQ(points.size(), 41);
+    CHECK_EQ(points.front().time, 120);
+    CHECK_EQ(points.back().time, 160);
+    CHECK_EQ(points.front().value, 3 * 120);
+
+    // All channels combined: RSSI is weighted by each channel's frames
+    query = {METRIC_RSSI, 0, 120, 120, nullptr, nullptr};
+    points = read_ring(ring, query);
+    CHECK_EQ(points.size(), 1);
+    CHECK_EQ(points[0].value, (-80 * 120 + -50 * 240) / 360);
+
+    // Channels with no frames report no RSSI
+    query = {METRIC_RSSI, 1, 100, 199, nullptr, nullptr};
+    CHECK_EQ(read_ring(ring, query).size(), 0);
+
+    // Windows outside the stored range decode nothing
+    query = {METRIC_FRAMES, 0, 300, 400, nullptr, nullptr};
+    CHECK_EQ(read_ring(ring, query).size(), 0);
+    query = {METRIC_FRAMES, 0, 0, 99, nullptr, nullptr};
+    CHECK_EQ(read_ring(ring, query).size(), 0);
+
+    metric_t metric;
+    CHECK(parse_metric_name("devices", &metric) && metric == METRIC_DEVICES);
+    CHECK(!parse_metric_name("packets", &metric));
+}
+
+static void test_accumulator() {
+    MetricAccumulator second, minute;
+    uint8_t mac[6] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x00};
+    for (int i = 0; i < 40; i++) {
+        mac[5] = i % 20;
+        second.add_frame(6, 100, i % 2 ? -40 : -60, mac);
+    }
+    second.add_frame(0, 100, -40, mac);  // out of range, ignored
+    second.add_frame(15, 100, -40, mac); // out of range, ignored
+    minute.merge(second);
+    minute.merge(second);
+
+    metric_sample_t sample;
+    minute.to_sample(60, &sample);
+    CHECK_EQ(sample.time, 60);
+    CHECK_EQ(sample.channels[5].frames, 80);
+    CHECK_EQ(sample.channels[5].bytes, 8000);
+    CHECK_EQ(sample.channels[5].rssi, -50);
+    // Merging the same devices twice must not double the distinct count
+    CHECK(sample.channels[5].devices >= 18 && sample.channels[5].devices <= 22);
+    CHECK_EQ(sample.channels[0].frames, 0);
+}
+
+int main() {
+    test_round_trip();
+    test_wrap_and_flush();
+    test_query_window();
+    test_accumulator();
+    return check_report("metric_store");
+}
@@ -0,0 +1,161 @@
+// Host-side checks for src/mgmt_frame.cpp and src/net_inventory.cpp: IE iteration bounds,
+// RSN parsing, and inventory eviction.
+
+#include <string.h>
+#include <vector>
+
+#include "check.h"
+#include "mgmt_frame.h"
+#include "net_inventory.h"
+
+// Builds a beacon (or probe response) from a list of raw information elements
+static std::vector<uint8_t> make_frame(uint8_t subtype, uint16_t capability,
+                                       const std::vector<std::vector<uint8_t>> &ies,
+                                       uint8_t last_octet = 0x01) {
+    std::vector<uint8_t> frame(MGMT_HEADER_LEN, 0);
+    frame[0] = subtype << 4;
+    for (int i = 0; i < 6; i++) {
+        frame[10 + i] = 0x10 + i; // addr2
+        frame[16 + i] = 0x20 + i; // addr3
+    }
+    frame[15] = frame[21] = last_octet;
+    if (subtype != MGMT_SUBTYPE_PROBE_REQ) {
+        uint8_t fixed[MGMT_FIXED_LEN] = {0};
+        fixed[8] = 100; // beacon interval
+        fixed[10] = capability & 0xff;
+        fixed[11] = capability >> 8;
+        frame.insert(frame.end(), fixed, fixed + MGMT_FIXED_LEN);
+    }
+    for (const auto &ie : ies) {
+        frame.insert(frame.end(), ie.begin(), ie.end());
+    }
+    return frame;
+}
+
+static std::vector<uint8_t> ssid_ie(const char *ssid) {
+    std::vector<uint8_t> ie = {IE_SSID, (uint8_t)strlen(ssid)};
+    ie.insert(ie.end(), ssid, ssid + strlen(ssid));
+    return ie;
+}
+
+static std::vector<uint8_t> rsn_ie(std::vector<uint8_t> akms) {
+    std::vector<uint8_t> ie = {IE_RSN, 0,    1,    0, // version
+                               0x00,   0x0f, 0xac, 4, // group cipher
+                               1,      0,             // pairwise count
+                               0x00,   0x0f, 0xac, 4, (uint8_t)akms.size(), 0};
+    for (uint8_t akm : akms) {
+        ie.insert(ie.end(), {0x00, 0x0f, 0xac, akm});
+    }
+    ie[1] = ie.size() - 2;
+    return ie;
+}
+
+static void test_ie_iterator() {
+    const uint8_t data[] = {0, 2, 'a', 'b', 3, 1, 6, 48, 10, 1};
+    IEIterator it(data, sizeof(data));
+    ie_t ie;
+    CHECK(it.next(&ie));
+    CHECK_EQ(ie.id, 0);
+    CHECK_EQ(ie.len, 2);
+    CHECK(ie.data == data + 2);
+    CHECK(it.next(&ie));
+    CHECK_EQ(ie.id, 3);
+    CHECK_EQ(ie.data[0], 6);
+    // The last element claims more bytes than remain
+    CHECK(!it.next(&ie));
+    CHECK(!it.next(&ie));
+
+    IEIterator empty(data, 1);
+    CHECK(!empty.next(&ie));
+}
+
+static void test_parse() {
+    mgmt_frame_info_t info;
+    std::vector<uint8_t> ds = {IE_DS_PARAMS, 1, 11};
+
+    auto frame = make_frame(MGMT_SUBTYPE_BEACON, CAP_PRIVACY, {ssid_ie("lab"), ds, rsn_ie({2})});
+    CHECK(parse_mgmt_frame(frame.data(), frame.size(), &info));
+    CHECK_EQ(info.subtype, MGMT_SUBTYPE_BEACON);
+    CHECK_EQ(info.ssid_len, 3);
+    CHECK(memcmp(info.ssid, "lab", 3) == 0);
+    CHECK_EQ(info.channel, 11);
+    CHECK_EQ(info.beacon_interval, 100);
+    CHECK(info.source == frame.data() + 10);
+    CHECK(info.bssid == frame.data() + 16);
+    CHECK_EQ(info.security, SECURITY_WPA2);
+
+    // SAE anywhere in the AKM list means WPA3, including transition mode
+    frame = make_frame(MGMT_SUBTYPE_PROBE_RESP, CAP_PRIVACY, {rsn_ie({2, 8})});
+    CHECK(parse_mgmt_frame(frame.data(), frame.size(), &info));
+    CHECK_EQ(info.security, SECURITY_WPA3);
+    frame = make_frame(MGMT_SUBTYPE_BEACON, CAP_PRIVACY, {rsn_ie({24})});
+    CHECK(parse_mgmt_frame(frame.data(), frame.size(), &info));
+    CHECK_EQ(info.security, SECURITY_WPA3);
+
+    std::vector<uint8_t> wpa = {IE_VENDOR, 4, 0x00, 0x50, 0xf2, 1};
+    frame = make_frame(MGMT_SUBTYPE_BEACON, CAP_PRIVACY, {wpa});
+    CHECK(parse_mgmt_frame(frame.data(), frame.size(), &info));
+    CHECK_EQ(info.security, SECURITY_WPA);
+
+    frame = make_frame(MGMT_SUBTYPE_BEACON, CAP_PRIVACY, {});
+    CHECK(parse_mgmt_frame(frame.data(), frame.size(), &info));
+    CHECK_EQ(info.security, SECURITY_WEP);
+    frame = make_frame(MGMT_SUBTYPE_BEACON, 0, {ssid_ie("")});
+    CHECK(parse_mgmt_frame(frame.data(), frame.size(), &info));
+    CHECK_EQ(info.security, SECURITY_OPEN);
+    CHECK_EQ(info.channel, 0);
+
+    // A pairwise count that runs past the element falls back to WPA2 without overreading
+    auto rsn = rsn_ie({8});
+    rsn[8] = rsn[9] = 0xff;
+    frame = make_frame(MGMT_SUBTYPE_BEACON, CAP_PRIVACY, {rsn});
+    CHECK(parse_mgmt_frame(frame.data(), frame.size(), &info));
+    CHECK_EQ(info.security, SECURITY_WPA2);
+
+    // Elements after a truncated one are ignored, but the frame still parses
+    frame = make_frame(MGMT_SUBTYPE_BEACON, CAP_PRIVACY, {ssid_ie("lab"), rsn_ie({8})});
+    CHECK(parse_mgmt_frame(frame.data(), frame.size() - 1, &info));
+    CHECK_EQ(info.ssid_len, 3);
+    CHECK_EQ(info.security, SECURITY_WEP);
+
+    // Probe requests have no fixed fields and never report security
+    frame = make_frame(MGMT_SUBTYPE_PROBE_REQ, 0, {ssid_ie("lab"), rsn_ie({8})});
+    CHECK(parse_mgmt_frame(frame.data(), frame.size(), &info));
+    CHECK_EQ(info.ssid_len, 3);
+    CHECK_EQ(info.security, SECURITY_UNKNOWN);
+
+    // Too short, not management, or an unsupported subtype
+    CHECK(!parse_mgmt_frame(frame.data(), MGMT_HEADER_LEN - 1, &info));
+    frame = make_frame(MGMT_SUBTYPE_BEACON, 0, {});
+    CHECK(!parse_mgmt_frame(frame.data(), MGMT_HEADER_LEN + MGMT_FIXED_LEN - 1, &info));
+    frame[0] = 0x08; // data frame
+    CHECK(!parse_mgmt_frame(frame.data(), frame.size(), &info));
+    frame[0] = 0xb0; // authentication
+    CHECK(!parse_mgmt_frame(frame.data(), frame.size(), &info));
+}
+
+static void test_inventory() {
+    NetInventory inventory;
+    mgmt_frame_info_t info;
+    for (int i = 0; i < 100; i++) {
+        auto frame = make_frame(MGMT_SUBTYPE_BEACON, 0, {ssid_ie("lab")}, (uint8_t)i);
+        CHECK(parse_mgmt_frame(frame.data(), frame.size(), &info));
+        inventory.record(info, -50, 6, i);
+    }
+    // The table keeps the most recently seen networks once it is full
+    CHECK_EQ(inventory.network_count(), INVENTORY_MAX_NETWORKS);
+    for (size_t i = 0; i < inventory.network_count(); i++) {
+        CHECK(inventory.network(i).last_seen >= 100 - INVENTORY_MAX_NETWORKS);
+        CHECK(strcmp(inventory.network(i).ssid, "lab") == 0);
+    }
+
+    inventory.clear();
+    CHECK_EQ(inventory.network_count(), 0);
+}
+
+int main() {
+    test_ie_iterator();
+    test_parse();
+    test_inventory();
+    return check_report("mgmt_frame");
+}
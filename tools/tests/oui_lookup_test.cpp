@@ -0,0 +1,94 @@
+// Host-side checks for the longest-prefix OUI database: reads a file written by
+// tools/oui/build_oui_db.py from fixtures/ with the firmware's src/oui_lookup.cpp, built
+// against the Arduino shims in arduino/.
+//
+//   oui_lookup_test ouis.lpm
+
+#include <string.h>
+
+#include "check.h"
+#include "oui_lookup.h"
+
+typedef struct {
+    uint8_t mac[6];
+    const char *manufacturer;
+} lookup_case_t;
+
+static const lookup_case_t CASES[] = {
+    {{0x00, 0x11, 0x22, 0x33, 0x44, 0x55}, "Acme Corp"},
+    // MA-S block inside a split OUI
+    {{0x70, 0xb3, 0xd5, 0x12, 0x34, 0x56}, "MasCo"},
+    // Unassigned block of a split OUI is unknown, not the registration authority
+    {{0x70, 0xb3, 0xd5, 0x99, 0x00, 0x00}, ""},
+    // MA-M block, and an unassigned one next to it
+    {{0x3c, 0x24, 0xf0, 0x1a, 0xbc, 0xde}, "MamCo"},
+    {{0x3c, 0x24, 0xf0, 0x2a, 0xbc, 0xde}, ""},
+    // Names are truncated to fit without leaving trailing whitespace
+    {{0xa4, 0xbb, 0xcc, 0x00, 0x00, 0x01}, "Very Long Name Incorporated AB"},
+    {{0x00, 0x11, 0x23, 0x00, 0x00, 0x01}, ""},
+};
+
+static void test_address_kinds() {
+    const uint8_t broadcast[6] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    const uint8_t ipv6_multicast[6] = {0x33, 0x33, 0x00, 0x00, 0x00, 0x01};
+    const uint8_t randomized[6] = {0x02, 0x11, 0x22, 0x33, 0x44, 0x55};
+    const uint8_t global[6] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55};
+
+    CHECK(isGroupAddress(broadcast) && !isLocallyAdministered(broadcast));
+    CHECK(isGroupAddress(ipv6_multicast) && !isLocallyAdministered(ipv6_multicast));
+    CHECK(!isGroupAddress(randomized) && isLocallyAdministered(randomized));
+    CHECK(!isGroupAddress(global) && !isLocallyAdministered(global));
+
+    // None of them carry a registered prefix
+    CHECK(findManufacturer(broadcast) == "");
+    CHECK(findManufacturer(ipv6_multicast) == "");
+    CHECK(findManufacturer(randomized) == "");
+}
+
+static void test_lookups() {
+    for (const lookup_case_t &c : CASES) {
+        int reads = File::reads;
+        String manufacturer = findManufacturer(c.mac);
+        if (manufacturer != c.manufacturer) {
+            fprintf(stderr, "%02X:%02X:%02X:%02X: got \"%s\", expected \"%s\"\n", c.mac[0],
+                    c.mac[1], c.mac[2], c.mac[3], manufacturer.c_str(), c.manufacturer);
+            check_failures++;
+        }
+        // An uncached lookup is at most one read of a single bucket
+        CHECK(File::reads - reads <= 1);
+    }
+
+    // Hits and misses are both served from the cache the second time
+    int reads = File::reads;
+    for (const lookup_case_t &c : CASES) {
+        CHECK(findManufacturer(c.mac) == c.manufacturer);
+    }
+    CHECK_EQ(File::reads, reads);
+}
+
+// Enough MA-L entries to spread over several buckets, so the generator and the firmware
+// must agree on the hash
+static void test_buckets() {
+    for (int i = 0; i < 40; i++) {
+        uint8_t mac[6] = {0x00, 0x00, (uint8_t)i, 0x12, 0x34, 0x56};
+        char expected[16];
+        snprintf(expected, sizeof(expected), "Vendor %02X", i);
+        CHECK(findManufacturer(mac) == expected);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s ouis.lpm\n", argv[0]);
+        return 2;
+    }
+    CHECK(!loadOUIDatabase("does-not-exist.lpm"));
+    CHECK(!ouiDatabaseLoaded());
+    CHECK(loadOUIDatabase(argv[1]));
+    CHECK(ouiDatabaseLoaded());
+
+    test_address_kinds();
+    test_lookups();
+    test_buckets();
+    return check_report("oui_lookup");
+}